@@ -3,8 +3,14 @@
 layout(location = 0) in vec3 aPos;
 
 uniform mat4 uModel;
-uniform mat4 uView;
-uniform mat4 uProjection;
+
+// 所有程序共享的相机参数（CameraBlock，绑定点 0）
+layout(std140) uniform CameraBlock
+{
+    mat4 uView;
+    mat4 uProjection;
+    vec3 uViewPos;
+};
 
 void main()
 {
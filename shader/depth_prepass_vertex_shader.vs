@@ -0,0 +1,27 @@
+#version 410 core
+// 深度预渲染：只写相机深度，之后主 pass 以 GL_EQUAL 测试，每个像素只执行一次光照着色器
+layout (location = 0) in vec3 aPos;
+
+#ifdef USE_INSTANCING
+layout (location = 3) in mat4 aInstanceModel;
+#define MODEL_MATRIX aInstanceModel
+#else
+uniform mat4 uModel;
+#define MODEL_MATRIX uModel
+#endif
+
+// 所有程序共享的相机参数（CameraBlock，绑定点 0）
+layout(std140) uniform CameraBlock
+{
+    mat4 uView;
+    mat4 uProjection;
+    vec3 uViewPos;
+};
+
+// 与 phone_vertex_shader.vs 使用相同的表达式并声明 invariant，保证两个程序算出的深度逐位相同
+invariant gl_Position;
+
+void main()
+{
+    gl_Position = uProjection * uView * MODEL_MATRIX * vec4(aPos, 1.0);
+}
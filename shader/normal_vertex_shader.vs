@@ -2,15 +2,37 @@
 
 // 输入顶点数据（位置和法线）
 layout (location = 0) in vec3 aPos;
+#ifdef OCTAHEDRAL_NORMAL
+// 压缩顶点格式：法线为八面体编码的 2 个 snorm16 分量
+layout (location = 1) in vec2 aNormal;
+vec3 decodeNormal()
+{
+    vec3 n = vec3(aNormal, 1.0 - abs(aNormal.x) - abs(aNormal.y));
+    float t = max(-n.z, 0.0);
+    n.xy += vec2(n.x >= 0.0 ? -t : t, n.y >= 0.0 ? -t : t);
+    return normalize(n);
+}
+#else
 layout (location = 1) in vec3 aNormal;
+vec3 decodeNormal()
+{
+    return aNormal;
+}
+#endif
 
 // 输出到片段着色器的法线
 out vec3 FragNormal;
 
 // 模型、视图、投影矩阵
 uniform mat4 uModel;
-uniform mat4 uView;
-uniform mat4 uProjection;
+
+// 所有程序共享的相机参数（CameraBlock，绑定点 0）
+layout(std140) uniform CameraBlock
+{
+    mat4 uView;
+    mat4 uProjection;
+    vec3 uViewPos;
+};
 
 void main()
 {
@@ -19,5 +41,5 @@ void main()
     
     // 计算世界空间法线（使用模型矩阵的逆转置矩阵确保正确变换）
     mat3 normalMatrix = transpose(inverse(mat3(uModel)));
-    FragNormal = normalMatrix * aNormal;
+    FragNormal = normalMatrix * decodeNormal();
 }
\ No newline at end of file
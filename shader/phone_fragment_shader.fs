@@ -4,17 +4,21 @@ out vec4 FragColor;
 in vec3 FragPos;  // 片段位置
 in vec3 Normal;   // 片段法线
 in vec2 TexCoord; // 纹理坐标
-in vec4 FragPosLightSpace;  // 顶点在光源空间中的位置
+flat in int MaterialIndex;  // 材质在 MaterialBlock 中的下标
 
-// 公共参数：视点位置
-uniform vec3 uViewPos;
+// 公共参数：视点位置（CameraBlock，绑定点 0）
+layout(std140) uniform CameraBlock
+{
+    mat4 uView;
+    mat4 uProjection;
+    vec3 uViewPos;
+};
 
 // -------------------------- 平行光结构体 --------------------------
 struct DirectionalLight {
     vec3 direction;  // 光线方向（例如：vec3(-0.2, -1.0, -0.3)）
     vec3 color;      // 光线颜色（例如：vec3(1.0, 1.0, 1.0)）
 };
-uniform DirectionalLight uDirLight;  // 平行光
 
 // -------------------------- 点光源结构体 --------------------------
 struct PointLight {
@@ -26,25 +30,64 @@ struct PointLight {
     float linear;    // 线性衰减（例如：0.09）
     float quadratic; // 二次衰减（例如：0.032）
 };
-uniform PointLight uPointLight;  // 点光源
+
+// 每帧写入一次的光源参数（LightBlock，绑定点 1）
+layout(std140) uniform LightBlock
+{
+    DirectionalLight uDirLight;  // 平行光
+    PointLight uPointLight;      // 点光源
+};
 
 // -------------------------- 材质参数 --------------------------
-uniform vec3 uMaterialAmbient;   // 环境光反射率（例如：vec3(0.1)）
-uniform vec3 uMaterialSpecular;  // 镜面反射率（例如：vec3(0.5)）
-uniform float uMaterialShininess;        // 高光锐度（例如：32.0）
+// 所有 Phong 材质放在 MaterialBlock（绑定点 3）中，逐物体只传下标
+#define MAX_MATERIALS 64  // 需与 UniformBuffers.h 中的 MAX_MATERIALS 一致
+
+struct MaterialData {
+    vec3 diffuse;        // 漫反射颜色（纹理关闭时使用）
+    float shininess;     // 高光锐度（例如：32.0）
+    vec3 specular;       // 镜面反射率（例如：vec3(0.5)）
+    int useDiffuseMap;   // 是否使用漫反射贴图
+    vec3 ambient;        // 环境光反射率（例如：vec3(0.1)）
+};
+
+layout(std140) uniform MaterialBlock
+{
+    MaterialData uMaterials[MAX_MATERIALS];
+};
 
 // 纹理控制
-uniform bool uUseDiffuseMap;
 uniform sampler2D uDiffuseMap;
-uniform vec3 uMaterialDiffuse;   // 漫反射颜色（纹理关闭时使用）
-
-// 平行光阴影
-uniform sampler2D uShadowMap;  // 阴影图纹理
 
-// 点光源阴影
-uniform samplerCube uPointShadowMap;  // 点光源阴影立方体贴图
-uniform vec3 uPointLightPos;         // 点光源位置
-uniform float uPointLightFar;        // 点光源视锥体范围（=25.0）
+// 平行光阴影 / 点光源阴影（ShadowBlock，绑定点 2）
+// 平行光阴影图是纹理数组，每个级联一层；点光源的 6 个面画在阴影图集的图块里（矩阴影时为立方体矩图）
+// SHADOW_COMPARE：阴影图开启深度比较和线性过滤，一次采样返回相邻 2x2 个纹素比较结果的双线性插值
+// SHADOW_VSM / SHADOW_EVSM：采样的是模糊过并带 mipmap 的矩图，每个光源一次采样
+#if defined(SHADOW_VSM) || defined(SHADOW_EVSM)
+#define SHADOW_MOMENTS
+#endif
+#ifdef SHADOW_COMPARE
+uniform sampler2DArrayShadow uShadowMap;
+uniform sampler2DShadow uPointShadowMap;
+#elif defined(SHADOW_MOMENTS)
+uniform sampler2DArray uShadowMap;   // 平行光矩图
+uniform samplerCube uPointShadowMap; // 点光源矩图（深度为 距离 / 远平面）
+#else
+uniform sampler2DArray uShadowMap;  // 阴影图纹理
+uniform sampler2D uPointShadowMap;  // 阴影图集（点光源的面存的是 距离 / 远平面）
+#endif
+#define MAX_CASCADES 4  // 需与 UniformBuffers.h 中的 MAX_SHADOW_CASCADES 一致
+layout(std140) uniform ShadowBlock
+{
+    mat4 uCascadeMatrices[MAX_CASCADES]; // 平行光每级的光源空间矩阵
+    vec4 uCascadeSplits;         // 每级覆盖到的视空间深度
+    vec4 uCascadeBiasScale;      // 每级深度偏移的缩放（各级正交投影的深度范围不同）
+    vec3 uPointLightPos;         // 点光源位置
+    float uPointLightFar;        // 点光源视锥体范围
+    float uLightBleedReduction;  // 矩阴影的漏光抑制：可见比例低于它的视为全黑（0 关闭）
+    int uCascadeCount;           // 级联数量（固定阴影图时为 1）
+    float uCascadeBlend;         // 每级末尾与下一级混合的比例（0 关闭）
+    vec4 uPointShadowTiles[6];   // 点光源每个面在阴影图集中的图块：xy 偏移，z 缩放，w 半个纹素（图块内坐标）
+};
 
 // 用于点光源阴影的采样偏移方向（20 个样本）
 const vec3 sampleOffsetDirections[20] = vec3[20](
@@ -73,7 +116,7 @@ const vec3 sampleOffsetDirections[20] = vec3[20](
 
 // -------------------------- 光照计算函数 --------------------------
 // 计算平行光贡献
-vec3 calcDirLight(DirectionalLight light, vec3 normal, vec3 viewDir, vec3 baseColor) 
+vec3 calcDirLight(DirectionalLight light, MaterialData material, vec3 normal, vec3 viewDir, vec3 baseColor) 
 {
     vec3 lightDir = normalize(-light.direction);  // 平行光方向取反（指向光源）
     
@@ -83,17 +126,17 @@ vec3 calcDirLight(DirectionalLight light, vec3 normal, vec3 viewDir, vec3 baseCo
     
     // 镜面反射
     vec3 reflectDir = reflect(-lightDir, normal);
-    float spec = pow(max(dot(viewDir, reflectDir), 0.0), uMaterialShininess);
-    vec3 specular = spec * uMaterialSpecular * light.color;
+    float spec = pow(max(dot(viewDir, reflectDir), 0.0), material.shininess);
+    vec3 specular = spec * material.specular * light.color;
     
     // 环境光
-    vec3 ambient = uMaterialAmbient * light.color;
+    vec3 ambient = material.ambient * light.color;
     
     return ambient + diffuse + specular;
 }
 
 // 计算点光源贡献
-vec3 calcPointLight(PointLight light, vec3 normal, vec3 fragPos, vec3 viewDir, vec3 baseColor) 
+vec3 calcPointLight(PointLight light, MaterialData material, vec3 normal, vec3 fragPos, vec3 viewDir, vec3 baseColor) 
 {
     vec3 lightDir = normalize(light.position - fragPos);  // 从片段指向点光源
     
@@ -104,11 +147,11 @@ vec3 calcPointLight(PointLight light, vec3 normal, vec3 fragPos, vec3 viewDir, v
     // 镜面反射：优化高光计算逻辑，避免视角与法线平行时的异常
     vec3 reflectDir = reflect(-lightDir, normal);
     // 高光项添加0.001偏置，避免pow(0, 高shininess)导致的数值不稳定
-    float spec = pow(max(dot(viewDir, reflectDir), 0.001), uMaterialShininess);
-    vec3 specular = spec * uMaterialSpecular * light.color;
+    float spec = pow(max(dot(viewDir, reflectDir), 0.001), material.shininess);
+    vec3 specular = spec * material.specular * light.color;
     
     // 环境光：保持不变（基础亮度）
-    vec3 ambient = uMaterialAmbient * light.color;
+    vec3 ambient = material.ambient * light.color;
     
     // 衰减计算：优化衰减公式，避免近距离过亮+远距离衰减更自然
     float distance = length(light.position - fragPos);
@@ -128,12 +171,48 @@ vec3 calcPointLight(PointLight light, vec3 normal, vec3 fragPos, vec3 viewDir, v
     return  ambient + diffuse + specular;
 }
 
-// 计算软阴影（PCF滤波）
-float calculateShadow()
+#ifdef SHADOW_MOMENTS
+// EVSM 的正负指数，与 shadow_moments_resolve_fragment_shader.fs 保持一致
+const float EVSM_POSITIVE = 40.0;
+const float EVSM_NEGATIVE = 5.0;
+
+// 切比雪夫不等式：深度分布的均值和方差给出 "深度 >= depth" 的概率上限，即可见比例
+float chebyshev(vec2 moments, float depth, float minVariance)
+{
+    if (depth <= moments.x)
+        return 1.0;
+    float variance = max(moments.y - moments.x * moments.x, minVariance);
+    float d = depth - moments.x;
+    float visibility = variance / (variance + d * d);
+    // 漏光抑制：把 [0, uLightBleedReduction] 截成 0，其余线性映射回 [0, 1]
+    return clamp((visibility - uLightBleedReduction) / (1.0 - uLightBleedReduction), 0.0, 1.0);
+}
+
+// 由一次采样得到的矩估计可见比例（1 为完全照亮）
+float momentVisibility(vec4 moments, float depth)
+{
+#ifdef SHADOW_EVSM
+    // 正负两个指数变换各估计一次，取较小值；最小方差随变换后的深度缩放
+    float warped = depth * 2.0 - 1.0;
+    float positive = exp(EVSM_POSITIVE * warped);
+    float negative = -exp(-EVSM_NEGATIVE * warped);
+    vec2 depthScale = 0.0001 * vec2(EVSM_POSITIVE * positive, EVSM_NEGATIVE * negative);
+    return min(chebyshev(moments.xy, positive, depthScale.x * depthScale.x),
+               chebyshev(moments.zw, negative, depthScale.y * depthScale.y));
+#else
+    return chebyshev(moments.xy, depth, 0.00002);
+#endif
+}
+#endif
+
+// 计算第 cascade 级阴影图上的软阴影（PCF滤波）
+float cascadeShadow(int cascade)
 {
     // 1. 转换光源空间坐标到纹理采样坐标（[0,1]范围）
-    vec3 projCoords = FragPosLightSpace.xyz / FragPosLightSpace.w;
+    vec4 fragPosLightSpace = uCascadeMatrices[cascade] * vec4(FragPos, 1.0);
+    vec3 projCoords = fragPosLightSpace.xyz / fragPosLightSpace.w;
     projCoords = projCoords * 0.5 + 0.5;
+    float layer = float(cascade);
 
     // 超出阴影图范围 → 无阴影
     if (projCoords.z > 1.0)
@@ -142,19 +221,33 @@ float calculateShadow()
     // 2. 计算当前片段在光源视角下的深度（加偏移避免阴影acne）
     float currentDepth = projCoords.z;
     vec3 lightDir = normalize(-uDirLight.direction);
-    float bias = max(0.05 * (1.0 - dot(Normal, lightDir)), 0.005);
+    float bias = max(0.05 * (1.0 - dot(Normal, lightDir)), 0.005) * uCascadeBiasScale[cascade];
 
+#ifdef SHADOW_MOMENTS
+    // 矩图已经过模糊和 mipmap 预过滤，一次三线性采样即为 PCF 范围内的平均；超出范围时读到边框（深度 1.0）
+    return 1.0 - momentVisibility(texture(uShadowMap, vec3(projCoords.xy, layer)), currentDepth - bias);
+#else
     // 3. PCF核心：对阴影图周围像素采样（5x5范围，可调整）
     float shadow = 0.0;
-    vec2 texelSize = 1.0 / textureSize(uShadowMap, 0); // 阴影图的像素大小（1/宽，1/高）
+    vec2 texelSize = 1.0 / textureSize(uShadowMap, 0).xy; // 阴影图的像素大小（1/宽，1/高）
 
+#ifdef SHADOW_COMPARE
+    // 3x3 次硬件比较，间隔 1.5 个纹素：每次覆盖 2x2 个纹素，合起来约等于 5x5 的范围
+    // 返回值是未被遮挡的比例（参考深度 <= 阴影图深度）；超出范围时和边框深度 1.0 比较，视为无阴影
+    for(int x = -1; x <= 1; ++x)
+    {
+        for(int y = -1; y <= 1; ++y)
+            shadow += texture(uShadowMap, vec4(projCoords.xy + vec2(x, y) * 1.5 * texelSize, layer, currentDepth - bias));
+    }
+    return 1.0 - shadow / 9.0;
+#else
     // 遍历周围5x5个像素（可改为3x3提升性能，或7x7更模糊）
     for(int x = -2; x <= 2; ++x)
     {
         for(int y = -2; y <= 2; ++y)
         {
             // 采样周围像素的深度
-            float pcfDepth = texture(uShadowMap, projCoords.xy + vec2(x, y) * texelSize).r;
+            float pcfDepth = texture(uShadowMap, vec3(projCoords.xy + vec2(x, y) * texelSize, layer)).r;
             // 统计在阴影中的像素数（当前深度 > 采样深度 + 偏移 → 算阴影）
             shadow += (currentDepth - bias > pcfDepth) ? 1.0 : 0.0;
         }
@@ -163,9 +256,60 @@ float calculateShadow()
     // 4. 取平均：阴影比例 = 阴影像素数 / 总采样数
     shadow /= 25.0; // 5x5=25个采样点（3x3则除以9）
 
+    return shadow;
+#endif
+#endif
+}
+
+// 按片段的视空间深度选择级联；每级末尾的混合带内与下一级线性混合（最后一级淡出为无阴影）
+float calculateShadow()
+{
+    float viewDepth = -(uView * vec4(FragPos, 1.0)).z;
+    int cascade = 0;
+    while (cascade < uCascadeCount - 1 && viewDepth > uCascadeSplits[cascade])
+        ++cascade;
+    float splitFar = uCascadeSplits[cascade];
+    if (viewDepth > splitFar)
+        return 0.0;
+
+    float shadow = cascadeShadow(cascade);
+    float blendStart = mix(splitFar, cascade == 0 ? 0.0 : uCascadeSplits[cascade - 1], uCascadeBlend);
+    if (uCascadeBlend > 0.0 && viewDepth > blendStart)
+    {
+        float next = cascade + 1 < uCascadeCount ? cascadeShadow(cascade + 1) : 0.0;
+        shadow = mix(shadow, next, (viewDepth - blendStart) / (splitFar - blendStart));
+    }
     return shadow;
 }
 
+#ifndef SHADOW_MOMENTS
+// 方向 → 立方体的面和面内坐标（与 OpenGL 立方体贴图各面的 s / t 约定一致）→ 阴影图集中该面图块里的纹理坐标
+// 面内坐标限制在离图块边缘半个纹素以内，线性过滤 / 比较采样的 2x2 邻域不会读到相邻的图块
+vec2 pointShadowAtlasCoord(vec3 dir)
+{
+    vec3 a = abs(dir);
+    int face;
+    vec2 st;
+    if (a.x >= a.y && a.x >= a.z)
+    {
+        face = dir.x > 0.0 ? 0 : 1;
+        st = vec2(dir.x > 0.0 ? -dir.z : dir.z, -dir.y) / a.x;
+    }
+    else if (a.y >= a.z)
+    {
+        face = dir.y > 0.0 ? 2 : 3;
+        st = vec2(dir.x, dir.y > 0.0 ? dir.z : -dir.z) / a.y;
+    }
+    else
+    {
+        face = dir.z > 0.0 ? 4 : 5;
+        st = vec2(dir.z > 0.0 ? dir.x : -dir.x, -dir.y) / a.z;
+    }
+    vec4 tile = uPointShadowTiles[face];
+    return tile.xy + clamp(st * 0.5 + 0.5, tile.w, 1.0 - tile.w) * tile.z;
+}
+#endif
+
 float calculatePointShadow(vec3 fragPos)
 {
     vec3 fragToLight = fragPos - uPointLightPos;
@@ -178,28 +322,44 @@ float calculatePointShadow(vec3 fragPos)
     float bias   = 0.1;
 
     int samples = 20;  // 你可以慢慢加到 48
-    float diskRadius = (currentDepth / uPointLightFar) * 0.02;
+    // 扰动半径随距离增大；不随远平面变化（远平面按投射物体拟合，原来按远平面 15 调好的 0.02 / 15）
+    float diskRadius = currentDepth * (0.02 / 15.0);
+    // 远平面只包含到最远的投射物体：更远的片段与远平面比较，方向上没有投射物体（深度为清除值 1.0）时不在阴影中
+    float testDepth = min(currentDepth - bias, uPointLightFar);
 
+#ifdef SHADOW_MOMENTS
+    return 1.0 - momentVisibility(texture(uPointShadowMap, dir), testDepth / uPointLightFar);
+#elif defined(SHADOW_COMPARE)
+    // 每次硬件比较已经过滤了 2x2 个纹素，只取立方体 8 个角方向；图集里存的是 距离 / 远平面
+    // 每个方向单独选面，扰动跨过面的边界时读相邻面的图块
+    float compareDepth = testDepth / uPointLightFar;
+    for (int i = 0; i < 8; ++i)
+        shadow += texture(uPointShadowMap, vec3(pointShadowAtlasCoord(dir + sampleOffsetDirections[i] * diskRadius), compareDepth));
+    return 1.0 - shadow / 8.0;
+#else
     for (int i = 0; i < samples; ++i)
     {
-        // 在单位球面方向附近扰动，必须 normalize
-        vec3 sampleDir = normalize(dir + sampleOffsetDirections[i] * diskRadius);
+        // 在单位球面方向附近扰动（选面时按主轴投影，不需要 normalize）
+        vec3 sampleDir = dir + sampleOffsetDirections[i] * diskRadius;
 
-        float closestDepth = texture(uPointShadowMap, sampleDir).r * uPointLightFar;
+        float closestDepth = texture(uPointShadowMap, pointShadowAtlasCoord(sampleDir)).r * uPointLightFar;
 
-        if (currentDepth - bias > closestDepth)
+        if (testDepth > closestDepth)
             shadow += 1.0;
     }
 
     shadow /= samples;
     return shadow;
+#endif
 }
 
 void main()
 {
+    MaterialData material = uMaterials[MaterialIndex];
+
     // 基础颜色（纹理或材质漫反射色）
-    vec3 baseColor = uMaterialDiffuse;
-    if (uUseDiffuseMap) 
+    vec3 baseColor = material.diffuse;
+    if (material.useDiffuseMap != 0) 
     {
         baseColor = texture(uDiffuseMap, TexCoord).rgb;
     }
@@ -209,8 +369,8 @@ void main()
     vec3 viewDir = normalize(uViewPos - FragPos);  // 从片段到视点
     
     // 累加两个光源的贡献
-    vec3 dirResult =  calcDirLight(uDirLight, normal, viewDir, baseColor);  // 平行光
-    vec3 pointResult = calcPointLight(uPointLight, normal, FragPos, viewDir, baseColor);  // 点光源
+    vec3 dirResult =  calcDirLight(uDirLight, material, normal, viewDir, baseColor);  // 平行光
+    vec3 pointResult = calcPointLight(uPointLight, material, normal, FragPos, viewDir, baseColor);  // 点光源
 
     // 计算阴影
     float dirShadow = calculateShadow();
@@ -1,28 +1,76 @@
 #version 410 core
 layout (location = 0) in vec3 aPos;
+#ifdef OCTAHEDRAL_NORMAL
+// 压缩顶点格式：法线为八面体编码的 2 个 snorm16 分量
+layout (location = 1) in vec2 aNormal;
+vec3 decodeNormal()
+{
+    vec3 n = vec3(aNormal, 1.0 - abs(aNormal.x) - abs(aNormal.y));
+    float t = max(-n.z, 0.0);
+    n.xy += vec2(n.x >= 0.0 ? -t : t, n.y >= 0.0 ? -t : t);
+    return normalize(n);
+}
+#else
 layout (location = 1) in vec3 aNormal;
+vec3 decodeNormal()
+{
+    return aNormal;
+}
+#endif
 layout (location = 2) in vec2 aTexCoord;
 
+#ifdef USE_INSTANCING
+// 实例化绘制：模型矩阵和材质下标来自实例缓冲（每个实例前进一次）
+layout (location = 3) in mat4 aInstanceModel;
+layout (location = 7) in int aInstanceMaterial;
+#define MODEL_MATRIX aInstanceModel
+#define MATERIAL_INDEX aInstanceMaterial
+#else
 uniform mat4 uModel;
-uniform mat4 uView;
-uniform mat4 uProjection;
-uniform mat4 uLightSpaceMatrix;
+uniform int uMaterialIndex;
+#define MODEL_MATRIX uModel
+#define MATERIAL_INDEX uMaterialIndex
+#endif
+
+// 所有程序共享的相机参数（CameraBlock，绑定点 0）
+layout(std140) uniform CameraBlock
+{
+    mat4 uView;
+    mat4 uProjection;
+    vec3 uViewPos;
+};
+
+// 阴影参数（ShadowBlock，绑定点 2）
+#define MAX_CASCADES 4  // 需与 UniformBuffers.h 中的 MAX_SHADOW_CASCADES 一致
+layout(std140) uniform ShadowBlock
+{
+    mat4 uCascadeMatrices[MAX_CASCADES];
+    vec4 uCascadeSplits;
+    vec4 uCascadeBiasScale;
+    vec3 uPointLightPos;
+    float uPointLightFar;
+    float uLightBleedReduction;
+    int uCascadeCount;
+    float uCascadeBlend;
+    vec4 uPointShadowTiles[6];
+};
 
 out vec3 FragPos;
 out vec3 Normal;
 out vec2 TexCoord;
-out vec4 FragPosLightSpace; 
+flat out int MaterialIndex; // 材质在 MaterialBlock 中的下标
+
+// 深度预渲染开启时主 pass 以 GL_EQUAL 测试深度，位置计算需要与 depth_prepass_vertex_shader.vs 逐位一致
+invariant gl_Position;
 
 void main()
 {
     // 计算片段的世界坐标和法线
-    FragPos = vec3(uModel * vec4(aPos, 1.0));
-    Normal = normalize(mat3(transpose(inverse(uModel))) * aNormal);  // 处理法线
+    FragPos = vec3(MODEL_MATRIX * vec4(aPos, 1.0));
+    Normal = normalize(mat3(transpose(inverse(MODEL_MATRIX))) * decodeNormal());  // 处理法线
     TexCoord = aTexCoord;
-
-    // 计算片段在光源视角中的坐标
-    FragPosLightSpace = uLightSpaceMatrix * vec4(FragPos, 1.0);
+    MaterialIndex = MATERIAL_INDEX;
 
     // 计算最终位置
-    gl_Position = uProjection * uView * uModel * vec4(aPos, 1.0);
+    gl_Position = uProjection * uView * MODEL_MATRIX * vec4(aPos, 1.0);
 }
@@ -1,6 +1,20 @@
 #version 410 core
 in vec3 FragPos; // 顶点到点光源的相对位置
-uniform float uPointLightFar; // 点光源远平面（=25.0）
+
+// 阴影参数（ShadowBlock，绑定点 2）
+#define MAX_CASCADES 4  // 需与 UniformBuffers.h 中的 MAX_SHADOW_CASCADES 一致
+layout(std140) uniform ShadowBlock
+{
+    mat4 uCascadeMatrices[MAX_CASCADES];
+    vec4 uCascadeSplits;
+    vec4 uCascadeBiasScale;
+    vec3 uPointLightPos;
+    float uPointLightFar;    // 点光源远平面
+    float uLightBleedReduction;
+    int uCascadeCount;
+    float uCascadeBlend;
+    vec4 uPointShadowTiles[6];
+};
 
 void main()
 {
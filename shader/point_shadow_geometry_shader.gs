@@ -0,0 +1,57 @@
+#version 410 core
+// 单次提交渲染点光源阴影：把每个三角形复制到它覆盖的面（gl_ViewportIndex 选择该面在阴影图集中的图块）
+layout (triangles) in;
+layout (triangle_strip, max_vertices = 18) out;
+
+uniform mat4 uPointVPMatrices[6]; // 6 个面的投影+视图矩阵
+
+// 阴影参数（ShadowBlock，绑定点 2）
+#define MAX_CASCADES 4  // 需与 UniformBuffers.h 中的 MAX_SHADOW_CASCADES 一致
+layout(std140) uniform ShadowBlock
+{
+    mat4 uCascadeMatrices[MAX_CASCADES];
+    vec4 uCascadeSplits;
+    vec4 uCascadeBiasScale;
+    vec3 uPointLightPos;
+    float uPointLightFar;
+    float uLightBleedReduction;
+    int uCascadeCount;
+    float uCascadeBlend;
+    vec4 uPointShadowTiles[6];
+};
+
+flat in int FaceMask[]; // 物体级剔除结果：需要渲染的面
+
+out vec3 FragPos; // 顶点到点光源的相对位置
+
+void main()
+{
+    for (int face = 0; face < 6; ++face)
+    {
+        if ((FaceMask[0] & (1 << face)) == 0)
+            continue;
+
+        vec4 clip[3];
+        for (int i = 0; i < 3; ++i)
+            clip[i] = uPointVPMatrices[face] * gl_in[i].gl_Position;
+
+        // 三个顶点都在同一个裁剪平面外侧时，三角形不会出现在这个面上
+        vec3 x = vec3(clip[0].x, clip[1].x, clip[2].x);
+        vec3 y = vec3(clip[0].y, clip[1].y, clip[2].y);
+        vec3 z = vec3(clip[0].z, clip[1].z, clip[2].z);
+        vec3 w = vec3(clip[0].w, clip[1].w, clip[2].w);
+        if (all(lessThan(x, -w)) || all(greaterThan(x, w)) ||
+            all(lessThan(y, -w)) || all(greaterThan(y, w)) ||
+            all(lessThan(z, -w)) || all(greaterThan(z, w)))
+            continue;
+
+        for (int i = 0; i < 3; ++i)
+        {
+            gl_ViewportIndex = face;
+            FragPos = gl_in[i].gl_Position.xyz - uPointLightPos;
+            gl_Position = clip[i];
+            EmitVertex();
+        }
+        EndPrimitive();
+    }
+}
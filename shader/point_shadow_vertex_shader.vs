@@ -1,15 +1,76 @@
 #version 410 core
+// 一次提交渲染 6 个面：LAYERED_VERTEX 在顶点着色器中写 gl_ViewportIndex（每个面的图块一个视口），需要以下扩展之一
+#ifdef LAYERED_VERTEX
+#if defined(GL_ARB_shader_viewport_layer_array)
+#extension GL_ARB_shader_viewport_layer_array : require
+#elif defined(GL_AMD_vertex_shader_viewport_index)
+#extension GL_AMD_vertex_shader_viewport_index : require
+#endif
+#endif
+
 layout (location = 0) in vec3 aPos;
 
-uniform mat4 uModel;        // 模型矩阵
-uniform mat4 uPointVPMatrix; // 点光源的投影+视图矩阵
-uniform vec3 uLightPos;     // 点光源位置
+#ifdef USE_INSTANCING
+// 实例化绘制：模型矩阵来自实例缓冲（每个实例前进一次）
+layout (location = 3) in mat4 aInstanceModel;
+layout (location = 8) in int aInstanceFaceMask; // 该物体需要渲染到的立方体贴图面（第 i 位对应第 i 个面）
+#define MODEL_MATRIX aInstanceModel
+#else
+uniform mat4 uModel;
+#define MODEL_MATRIX uModel
+#endif
+
+// 阴影参数（ShadowBlock，绑定点 2）
+#define MAX_CASCADES 4  // 需与 UniformBuffers.h 中的 MAX_SHADOW_CASCADES 一致
+layout(std140) uniform ShadowBlock
+{
+    mat4 uCascadeMatrices[MAX_CASCADES];
+    vec4 uCascadeSplits;
+    vec4 uCascadeBiasScale;
+    vec3 uPointLightPos;     // 点光源位置
+    float uPointLightFar;    // 点光源远平面
+    float uLightBleedReduction;
+    int uCascadeCount;
+    float uCascadeBlend;
+    vec4 uPointShadowTiles[6];
+};
+
+#if defined(LAYERED_GEOMETRY)
+// 一次提交渲染 6 个面：输出世界空间位置，由几何着色器投影到各个面
+flat out int FaceMask;
+
+void main()
+{
+    FaceMask = aInstanceFaceMask;
+    gl_Position = MODEL_MATRIX * vec4(aPos, 1.0);
+}
+#elif defined(LAYERED_VERTEX)
+// 一次提交渲染 6 个面：每个物体实例化 6 次（实例属性除数为 6），gl_InstanceID % 6 即面序号，也是视口序号
+uniform mat4 uPointVPMatrices[6];
+
+out vec3 FragPos;
+
+void main()
+{
+    int face = gl_InstanceID % 6;
+    vec3 worldPos = (MODEL_MATRIX * vec4(aPos, 1.0)).xyz;
+    FragPos = worldPos - uPointLightPos;
+    gl_ViewportIndex = face;
+    // 物体不在这个面的视锥体内：所有顶点落到同一个裁剪体外的点，三角形退化后被丢弃
+    if ((aInstanceFaceMask & (1 << face)) == 0)
+        gl_Position = vec4(2.0, 2.0, 2.0, 1.0);
+    else
+        gl_Position = uPointVPMatrices[face] * vec4(worldPos, 1.0);
+}
+#else
+uniform mat4 uPointVPMatrix; // 点光源的投影+视图矩阵（每个面设置一次）
 
 out vec3 FragPos; // 顶点到点光源的相对位置（传递给片段着色器）
 
 void main()
 {
-    vec3 worldPos = (uModel * vec4(aPos, 1.0)).xyz; // 世界空间位置
-    FragPos = worldPos - uLightPos;                 // 相对位置
+    vec3 worldPos = (MODEL_MATRIX * vec4(aPos, 1.0)).xyz; // 世界空间位置
+    FragPos = worldPos - uPointLightPos;                 // 相对位置
     gl_Position = uPointVPMatrix * vec4(worldPos, 1.0); // 裁剪空间位置（依赖VP矩阵）
-}
\ No newline at end of file
+}
+#endif
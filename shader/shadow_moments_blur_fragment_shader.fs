@@ -0,0 +1,20 @@
+#version 410 core
+out vec4 FragColor;
+
+// 矩图沿一个方向的盒式模糊（uAxis：0 水平，1 垂直），两次组成可分离的二维模糊；读取第 uLayer 层
+uniform sampler2DArray uSource;
+uniform int uLayer;
+uniform int uRadius;
+uniform int uAxis;
+
+void main()
+{
+    ivec2 texel = ivec2(gl_FragCoord.xy);
+    ivec2 size = textureSize(uSource, 0).xy;
+    ivec2 direction = uAxis == 0 ? ivec2(1, 0) : ivec2(0, 1);
+
+    vec4 sum = vec4(0.0);
+    for (int i = -uRadius; i <= uRadius; ++i)
+        sum += texelFetch(uSource, ivec3(clamp(texel + direction * i, ivec2(0), size - 1), uLayer), 0);
+    FragColor = sum / float(2 * uRadius + 1);
+}
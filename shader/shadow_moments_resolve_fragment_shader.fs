@@ -0,0 +1,52 @@
+#version 410 core
+out vec4 FragColor;
+
+// 深度图 → 矩：每个输出纹素取 uScale x uScale 个深度纹素的矩的平均（降采样）
+#ifdef ATLAS_SOURCE
+uniform sampler2D uSource; // 阴影图集（点光源的面存的是 距离 / 远平面）
+uniform ivec4 uTile;       // 当前处理的面的图块：xy 纹素位置，z 边长，w 输出矩图的边长
+#else
+uniform sampler2DArray uSource; // 平行光级联深度图
+uniform int uLayer;             // 当前处理的级联
+uniform int uScale;
+#endif
+
+// EVSM 的正负指数（32 位浮点下 e^(2*40) 仍不溢出），与 phone_fragment_shader.fs 保持一致
+const float EVSM_POSITIVE = 40.0;
+const float EVSM_NEGATIVE = 5.0;
+
+vec4 moments(float depth)
+{
+#ifdef SHADOW_EVSM
+    float warped = depth * 2.0 - 1.0;
+    float positive = exp(EVSM_POSITIVE * warped);
+    float negative = -exp(-EVSM_NEGATIVE * warped);
+    return vec4(positive, positive * positive, negative, negative * negative);
+#else
+    return vec4(depth, depth * depth, 0.0, 0.0);
+#endif
+}
+
+void main()
+{
+    vec4 sum = vec4(0.0);
+#ifdef ATLAS_SOURCE
+    // 图块比矩图大时按边长比降采样；图块更小（预算不够时）每个输出纹素只读一个深度纹素
+    int scale = max(uTile.z / uTile.w, 1);
+    ivec2 base = uTile.xy + ivec2(gl_FragCoord.xy) * uTile.z / uTile.w;
+    for (int x = 0; x < scale; ++x)
+    {
+        for (int y = 0; y < scale; ++y)
+            sum += moments(texelFetch(uSource, base + ivec2(x, y), 0).r);
+    }
+    FragColor = sum / float(scale * scale);
+#else
+    ivec2 base = ivec2(gl_FragCoord.xy) * uScale;
+    for (int x = 0; x < uScale; ++x)
+    {
+        for (int y = 0; y < uScale; ++y)
+            sum += moments(texelFetch(uSource, ivec3(base + ivec2(x, y), uLayer), 0).r);
+    }
+    FragColor = sum / float(uScale * uScale);
+#endif
+}
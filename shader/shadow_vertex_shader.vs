@@ -1,11 +1,33 @@
 #version 410 core
 layout (location = 0) in vec3 aPos;
 
-uniform mat4 uLightSpaceMatrix;  // 光源空间矩阵 = 光源投影矩阵 × 光源视图矩阵
-uniform mat4 uModel;             // 模型矩阵
+#ifdef USE_INSTANCING
+// 实例化绘制：模型矩阵来自实例缓冲（每个实例前进一次）
+layout (location = 3) in mat4 aInstanceModel;
+#define MODEL_MATRIX aInstanceModel
+#else
+uniform mat4 uModel;
+#define MODEL_MATRIX uModel
+#endif
+
+// 阴影参数（ShadowBlock，绑定点 2）
+#define MAX_CASCADES 4  // 需与 UniformBuffers.h 中的 MAX_SHADOW_CASCADES 一致
+layout(std140) uniform ShadowBlock
+{
+    mat4 uCascadeMatrices[MAX_CASCADES]; // 每级的光源空间矩阵 = 光源投影矩阵 × 光源视图矩阵
+    vec4 uCascadeSplits;
+    vec4 uCascadeBiasScale;
+    vec3 uPointLightPos;
+    float uPointLightFar;
+    float uLightBleedReduction;
+    int uCascadeCount;
+    float uCascadeBlend;
+    vec4 uPointShadowTiles[6];
+};
+uniform int uCascade; // 当前渲染的级联（阴影图数组的层）
 
 void main()
 {
     // 输出顶点在光源空间中的位置（用于深度比较）
-    gl_Position = uLightSpaceMatrix * uModel * vec4(aPos, 1.0);
+    gl_Position = uCascadeMatrices[uCascade] * MODEL_MATRIX * vec4(aPos, 1.0);
 }
\ No newline at end of file
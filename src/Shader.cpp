@@ -1,118 +1,230 @@
 #include "Shader.h"
+#include "render/GLState.h"
+#include "render/UniformBuffers.h"
+#include "tool/CpuProfiler.h"
 #include <iostream>
 #include <fstream>
 #include <sstream>
+#include <algorithm>
+#include <cstring>
 
 // 构造函数
-Shader::Shader(const char *vertexPath, const char *fragmentPath)
+Shader::Shader(const char *vertexPath, const char *fragmentPath, const std::vector<std::string> &defines)
+    : Shader(vertexPath, "", fragmentPath, defines)
 {
-    // 保存路径，用于报错时显示
-    std::string vPath = vertexPath;
-    std::string fPath = fragmentPath;
+}
 
-    // 从文件中读取着色器代码
-    std::string vertexCode;
-    std::string fragmentCode;
-    try
+Shader::Shader(const char *vertexPath, const char *geometryPath, const char *fragmentPath,
+               const std::vector<std::string> &defines)
+    : vertexPath(vertexPath), geometryPath(geometryPath), fragmentPath(fragmentPath), defines(defines)
+{
+    CPU_PROFILE_SCOPE("shader compile");
+    int success;
+    char infoLog[512];
+
+    unsigned int vertex = compileStage(GL_VERTEX_SHADER, "VERTEX", this->vertexPath, defines);
+    unsigned int geometry = 0;
+    if (!this->geometryPath.empty())
+        geometry = compileStage(GL_GEOMETRY_SHADER, "GEOMETRY", this->geometryPath, defines);
+    unsigned int fragment = compileStage(GL_FRAGMENT_SHADER, "FRAGMENT", this->fragmentPath, defines);
+
+    // 链接程序（报错时显示涉及的所有文件）
+    ID = glCreateProgram();
+    glAttachShader(ID, vertex);
+    if (geometry != 0)
+        glAttachShader(ID, geometry);
+    glAttachShader(ID, fragment);
+    glLinkProgram(ID);
+    glGetProgramiv(ID, GL_LINK_STATUS, &success);
+    if (!success)
     {
-        std::ifstream vertexShaderFile(vertexPath);
-        std::ifstream fragmentShaderFile(fragmentPath);
-        std::stringstream vertexShaderStream, fragmentShaderStream;
+        glGetProgramInfoLog(ID, 512, NULL, infoLog);
+        std::cout << "ERROR::SHADER::PROGRAM::LINKING_FAILED\n"
+                  << "Vertex File: " << this->vertexPath << "\n";
+        if (geometry != 0)
+            std::cout << "Geometry File: " << this->geometryPath << "\n";
+        std::cout << "Fragment File: " << this->fragmentPath << "\n"
+                  << infoLog << std::endl;
+    }
 
-        vertexShaderStream << vertexShaderFile.rdbuf();
-        fragmentShaderStream << fragmentShaderFile.rdbuf();
+    glDeleteShader(vertex);
+    if (geometry != 0)
+        glDeleteShader(geometry);
+    glDeleteShader(fragment);
 
-        vertexShaderFile.close();
-        fragmentShaderFile.close();
+    reflectUniforms();
+    bindSharedResources();
+    materialIndexHandle = handle("uMaterialIndex");
+}
 
-        vertexCode = vertexShaderStream.str();
-        fragmentCode = fragmentShaderStream.str();
+unsigned int Shader::compileStage(GLenum type, const char *typeName, const std::string &path,
+                                  const std::vector<std::string> &defines)
+{
+    // 从文件中读取着色器代码
+    std::string code;
+    try
+    {
+        std::ifstream shaderFile(path);
+        std::stringstream shaderStream;
+        shaderStream << shaderFile.rdbuf();
+        shaderFile.close();
+        code = injectDefines(shaderStream.str(), defines);
     }
     catch (std::exception &e)
     {
         std::cout << "ERROR::SHADER::FILE_NOT_SUCCESFULLY_READ" << std::endl;
     }
 
-    const char *vShaderCode = vertexCode.c_str();
-    const char *fShaderCode = fragmentCode.c_str();
-
-    unsigned int vertex, fragment;
+    const char *shaderCode = code.c_str();
     int success;
     char infoLog[512];
 
-    // 编译顶点着色器（报错时显示文件路径）
-    vertex = glCreateShader(GL_VERTEX_SHADER);
-    glShaderSource(vertex, 1, &vShaderCode, NULL);
-    glCompileShader(vertex);
-    glGetShaderiv(vertex, GL_COMPILE_STATUS, &success);
+    // 编译（报错时显示文件路径）
+    unsigned int shader = glCreateShader(type);
+    glShaderSource(shader, 1, &shaderCode, NULL);
+    glCompileShader(shader);
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
     if (!success)
     {
-        glGetShaderInfoLog(vertex, 512, NULL, infoLog);
-        std::cout << "ERROR::SHADER::VERTEX::COMPILATION_FAILED\n"
-                  << "File: " << vPath << "\n" // 显示顶点着色器路径
+        glGetShaderInfoLog(shader, 512, NULL, infoLog);
+        std::cout << "ERROR::SHADER::" << typeName << "::COMPILATION_FAILED\n"
+                  << "File: " << path << "\n"
                   << infoLog << std::endl;
     }
+    return shader;
+}
 
-    // 编译片段着色器（报错时显示文件路径）
-    fragment = glCreateShader(GL_FRAGMENT_SHADER);
-    glShaderSource(fragment, 1, &fShaderCode, NULL);
-    glCompileShader(fragment);
-    glGetShaderiv(fragment, GL_COMPILE_STATUS, &success);
-    if (!success)
+void Shader::bindSharedResources()
+{
+    // uniform block 绑定到所有程序共享的固定绑定点
+    int blockCount = 0;
+    glGetProgramiv(ID, GL_ACTIVE_UNIFORM_BLOCKS, &blockCount);
+    char blockName[128];
+    for (int i = 0; i < blockCount; ++i)
     {
-        glGetShaderInfoLog(fragment, 512, NULL, infoLog);
-        std::cout << "ERROR::SHADER::FRAGMENT::COMPILATION_FAILED\n"
-                  << "File: " << fPath << "\n" // 显示片段着色器路径
-                  << infoLog << std::endl;
+        glGetActiveUniformBlockName(ID, (GLuint)i, sizeof(blockName), NULL, blockName);
+        int binding = UniformBuffers::bindingFor(blockName);
+        if (binding >= 0)
+            glUniformBlockBinding(ID, (GLuint)i, (GLuint)binding);
+        else
+            std::cout << "WARNING::SHADER::UNKNOWN_UNIFORM_BLOCK " << blockName << std::endl;
     }
 
-    // 链接程序（报错时显示涉及的两个文件）
-    ID = glCreateProgram();
-    glAttachShader(ID, vertex);
-    glAttachShader(ID, fragment);
-    glLinkProgram(ID);
-    glGetProgramiv(ID, GL_LINK_STATUS, &success);
-    if (!success)
+    // 采样器使用固定纹理单元，之后不需要每次绘制再设置
+    for (const UniformEntry &entry : uniforms)
     {
-        glGetProgramInfoLog(ID, 512, NULL, infoLog);
-        std::cout << "ERROR::SHADER::PROGRAM::LINKING_FAILED\n"
-                  << "Vertex File: " << vPath << "\n"
-                  << "Fragment File: " << fPath << "\n"
-                  << infoLog << std::endl;
+        int unit = UniformBuffers::textureUnitFor(entry.name.c_str());
+        if (unit >= 0)
+            glProgramUniform1i(ID, entry.handle.location, unit);
     }
+}
 
-    glDeleteShader(vertex);
-    glDeleteShader(fragment);
+void Shader::reflectUniforms()
+{
+    uniforms.clear();
+
+    int count = 0, maxLength = 0;
+    glGetProgramiv(ID, GL_ACTIVE_UNIFORMS, &count);
+    glGetProgramiv(ID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+
+    std::vector<char> nameBuffer(std::max(maxLength, 1));
+    for (int i = 0; i < count; ++i)
+    {
+        GLsizei length = 0;
+        GLint size = 0;
+        GLenum type = 0;
+        glGetActiveUniform(ID, (GLuint)i, (GLsizei)nameBuffer.size(), &length, &size, &type, nameBuffer.data());
+
+        std::string name(nameBuffer.data(), length);
+        int location = glGetUniformLocation(ID, name.c_str());
+        if (location < 0)
+            continue; // uniform block 中的成员没有 location
+
+        uniforms.push_back({name, {location}});
+
+        // 数组以 "name[0]" 的形式返回，同时登记不带下标的名字和其余每个元素（各元素的 location 不一定连续）
+        if (name.size() > 3 && name.compare(name.size() - 3, 3, "[0]") == 0)
+        {
+            std::string base = name.substr(0, name.size() - 3);
+            uniforms.push_back({base, {location}});
+            for (int element = 1; element < size; ++element)
+            {
+                std::string elementName = base + "[" + std::to_string(element) + "]";
+                int elementLocation = glGetUniformLocation(ID, elementName.c_str());
+                if (elementLocation >= 0)
+                    uniforms.push_back({elementName, {elementLocation}});
+            }
+        }
+    }
+
+    std::sort(uniforms.begin(), uniforms.end(),
+              [](const UniformEntry &a, const UniformEntry &b)
+              { return a.name < b.name; });
+}
+
+UniformHandle Shader::handle(const char *name) const
+{
+    auto it = std::lower_bound(uniforms.begin(), uniforms.end(), name,
+                               [](const UniformEntry &entry, const char *key)
+                               { return std::strcmp(entry.name.c_str(), key) < 0; });
+    if (it != uniforms.end() && it->name == name)
+        return it->handle;
+    return UniformHandle();
+}
+
+std::string Shader::injectDefines(const std::string &source, const std::vector<std::string> &defines)
+{
+    if (defines.empty())
+        return source;
+
+    std::string defineBlock;
+    for (const std::string &define : defines)
+        defineBlock += "#define " + define + "\n";
+
+    // #version 必须是第一条语句，宏定义插在它的下一行
+    size_t versionPos = source.find("#version");
+    if (versionPos == std::string::npos)
+        return defineBlock + source;
+    size_t lineEnd = source.find('\n', versionPos);
+    if (lineEnd == std::string::npos)
+        return source + "\n" + defineBlock;
+    return source.substr(0, lineEnd + 1) + defineBlock + source.substr(lineEnd + 1);
+}
+
+Shader::~Shader()
+{
+    GLState::forgetProgram(ID);
+    glDeleteProgram(ID);
 }
 
-// 使用着色器程序
+// 使用着色器程序（已经在使用时不重复调用 glUseProgram）
 void Shader::use()
 {
-    glUseProgram(ID);
+    GLState::useProgram(ID);
 }
 
 // 设置uniform变量
-void Shader::setBool(const std::string &name, bool value) const
+void Shader::setBool(const char *name, bool value) const
 {
-    glUniform1i(glGetUniformLocation(ID, name.c_str()), (int)value);
+    set(handle(name), value);
 }
 
-void Shader::setInt(const std::string &name, int value) const
+void Shader::setInt(const char *name, int value) const
 {
-    glUniform1i(glGetUniformLocation(ID, name.c_str()), value);
+    set(handle(name), value);
 }
 
-void Shader::setFloat(const std::string &name, float value) const
+void Shader::setFloat(const char *name, float value) const
 {
-    glUniform1f(glGetUniformLocation(ID, name.c_str()), value);
+    set(handle(name), value);
 }
 
-void Shader::setVec3(const std::string &name, const glm::vec3 &value) const
+void Shader::setVec3(const char *name, const glm::vec3 &value) const
 {
-    glUniform3fv(glGetUniformLocation(ID, name.c_str()), 1, glm::value_ptr(value));
+    set(handle(name), value);
 }
 
-void Shader::setMat4(const std::string &name, const glm::mat4 &matrix) const
+void Shader::setMat4(const char *name, const glm::mat4 &matrix) const
 {
-    glUniformMatrix4fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, glm::value_ptr(matrix));
+    set(handle(name), matrix);
 }
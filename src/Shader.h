@@ -2,25 +2,89 @@
 
 #include <glad/glad.h>
 #include <string>
+#include <vector>
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 
+// uniform 句柄：链接后反射得到的 location
+// 热循环中先取句柄再调用 set()，不需要字符串查找
+struct UniformHandle
+{
+    int location = -1;
+
+    bool valid() const { return location >= 0; }
+};
+
 class Shader
 {
 public:
     unsigned int ID;
 
+    // 源文件路径和宏定义（ShaderLibrary 据此生成同一着色器的其他变体）
+    std::string vertexPath;
+    std::string geometryPath; // 没有几何着色器时为空
+    std::string fragmentPath;
+    std::vector<std::string> defines;
+
+    // uMaterialIndex 的句柄（链接后取一次，材质每次绘制直接使用）
+    UniformHandle materialIndexHandle;
+
     // 构造函数从文件中加载着色器
-    Shader(const char *vertexPath, const char *fragmentPath);
+    // defines 中的每一项会以 "#define xxx" 的形式插入到 #version 之后
+    Shader(const char *vertexPath, const char *fragmentPath, const std::vector<std::string> &defines = {});
+    // 带几何着色器的版本（geometryPath 为空字符串时等同于上面的构造函数）
+    Shader(const char *vertexPath, const char *geometryPath, const char *fragmentPath,
+           const std::vector<std::string> &defines);
+
+    // 释放程序对象（ShaderLibrary 中最后一个使用者释放时调用）
+    ~Shader();
+    // 持有 GL 程序对象，不能复制
+    Shader(const Shader &) = delete;
+    Shader &operator=(const Shader &) = delete;
 
     // 使用着色器程序
     void use();
 
-    // 设置uniform变量
-    void setBool(const std::string &name, bool value) const;
-    void setInt(const std::string &name, int value) const;
-    void setFloat(const std::string &name, float value) const;
-    void setVec3(const std::string &name, const glm::vec3 &value) const;
-    void setMat4(const std::string &name, const glm::mat4 &matrix) const;
+    // 查找 uniform 句柄（在反射表中二分查找，不存在时返回无效句柄）
+    UniformHandle handle(const char *name) const;
+
+    // 通过句柄设置uniform变量（无效句柄直接忽略）
+    void set(UniformHandle h, bool value) const { glUniform1i(h.location, (int)value); }
+    void set(UniformHandle h, int value) const { glUniform1i(h.location, value); }
+    void set(UniformHandle h, float value) const { glUniform1f(h.location, value); }
+    void set(UniformHandle h, const glm::vec3 &value) const { glUniform3fv(h.location, 1, glm::value_ptr(value)); }
+    void set(UniformHandle h, const glm::ivec4 &value) const { glUniform4iv(h.location, 1, glm::value_ptr(value)); }
+    void set(UniformHandle h, const glm::mat4 &matrix) const { glUniformMatrix4fv(h.location, 1, GL_FALSE, glm::value_ptr(matrix)); }
+    void set(UniformHandle h, const glm::mat4 *matrices, int count) const { glUniformMatrix4fv(h.location, count, GL_FALSE, glm::value_ptr(matrices[0])); }
+
+    // 设置uniform变量（按名字，查反射表而不是每次调用 glGetUniformLocation）
+    void setBool(const char *name, bool value) const;
+    void setInt(const char *name, int value) const;
+    void setFloat(const char *name, float value) const;
+    void setVec3(const char *name, const glm::vec3 &value) const;
+    void setMat4(const char *name, const glm::mat4 &matrix) const;
+
+private:
+    struct UniformEntry
+    {
+        std::string name;
+        UniformHandle handle;
+    };
+
+    // 链接后反射出的所有 active uniform，按名字排序
+    std::vector<UniformEntry> uniforms;
+
+    // 通过 glGetActiveUniform 建立 uniform 表
+    void reflectUniforms();
+
+    // 绑定共享的 uniform block 和采样器纹理单元
+    void bindSharedResources();
+
+    // 读取并编译一个着色器阶段，失败时输出文件路径和日志
+    static unsigned int compileStage(GLenum type, const char *typeName, const std::string &path,
+                                     const std::vector<std::string> &defines);
+
+    // 在 #version 行之后插入宏定义
+    static std::string injectDefines(const std::string &source, const std::vector<std::string> &defines);
 };
\ No newline at end of file
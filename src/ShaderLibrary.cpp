@@ -0,0 +1,86 @@
+#include "ShaderLibrary.h"
+
+#include <algorithm>
+#include <chrono>
+
+std::map<std::string, std::weak_ptr<Shader>> ShaderLibrary::programs;
+unsigned int ShaderLibrary::requests = 0;
+double ShaderLibrary::compileTimeMs = 0.0;
+std::vector<std::string> ShaderLibrary::globalDefines;
+
+std::shared_ptr<Shader> ShaderLibrary::get(const std::string &vertexPath, const std::string &fragmentPath,
+                                           const std::vector<std::string> &defines)
+{
+    return get(vertexPath, "", fragmentPath, defines);
+}
+
+std::shared_ptr<Shader> ShaderLibrary::get(const std::string &vertexPath, const std::string &geometryPath,
+                                           const std::string &fragmentPath, const std::vector<std::string> &requestedDefines)
+{
+    ++requests;
+
+    std::vector<std::string> defines = requestedDefines;
+    for (const std::string &define : globalDefines)
+    {
+        if (std::find(defines.begin(), defines.end(), define) == defines.end())
+            defines.push_back(define);
+    }
+
+    std::string key = makeKey(vertexPath, geometryPath, fragmentPath, defines);
+    std::shared_ptr<Shader> shader = programs[key].lock();
+    if (shader)
+        return shader;
+
+    auto begin = std::chrono::steady_clock::now();
+    shader = std::make_shared<Shader>(vertexPath.c_str(), geometryPath.c_str(), fragmentPath.c_str(), defines);
+    compileTimeMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+
+    // 顺便清理已经过期的项
+    for (auto it = programs.begin(); it != programs.end();)
+    {
+        if (it->second.expired())
+            it = programs.erase(it);
+        else
+            ++it;
+    }
+    programs[key] = shader;
+    return shader;
+}
+
+unsigned int ShaderLibrary::programCount()
+{
+    unsigned int count = 0;
+    for (const auto &entry : programs)
+    {
+        if (!entry.second.expired())
+            ++count;
+    }
+    return count;
+}
+
+std::shared_ptr<Shader> ShaderLibrary::variant(const Shader &base, const std::string &define)
+{
+    std::vector<std::string> defines = base.defines;
+    if (std::find(defines.begin(), defines.end(), define) == defines.end())
+        defines.push_back(define);
+    return get(base.vertexPath, base.geometryPath, base.fragmentPath, defines);
+}
+
+void ShaderLibrary::addGlobalDefine(const std::string &define)
+{
+    if (std::find(globalDefines.begin(), globalDefines.end(), define) == globalDefines.end())
+        globalDefines.push_back(define);
+}
+
+std::string ShaderLibrary::makeKey(const std::string &vertexPath, const std::string &geometryPath,
+                                   const std::string &fragmentPath, const std::vector<std::string> &defines)
+{
+    // 宏定义的顺序不影响结果，排序后再拼接
+    std::vector<std::string> sortedDefines = defines;
+    std::sort(sortedDefines.begin(), sortedDefines.end());
+
+    std::string key = vertexPath + "|" + geometryPath + "|" + fragmentPath;
+    for (const std::string &define : sortedDefines)
+        key += "|" + define;
+    return key;
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Shader.h"
+
+// 着色器程序库：按 (各阶段文件路径, 宏定义) 缓存已链接的程序
+// 相同组合只编译链接一次，所有使用者共享同一个 Shader
+class ShaderLibrary
+{
+public:
+    // 获取（必要时编译）着色器程序
+    static std::shared_ptr<Shader> get(const std::string &vertexPath, const std::string &fragmentPath,
+                                       const std::vector<std::string> &defines = {});
+    // 带几何着色器的程序
+    static std::shared_ptr<Shader> get(const std::string &vertexPath, const std::string &geometryPath,
+                                       const std::string &fragmentPath, const std::vector<std::string> &defines = {});
+
+    // 获取 base 额外加上一个宏定义后的变体（例如实例化版本 "USE_INSTANCING"）
+    static std::shared_ptr<Shader> variant(const Shader &base, const std::string &define);
+
+    // 之后获取的所有程序都带上的宏定义（例如压缩顶点格式的 "OCTAHEDRAL_NORMAL"），需在创建物体之前设置
+    static void addGlobalDefine(const std::string &define);
+
+    // 统计信息：请求次数、当前仍在使用的程序数、编译总耗时
+    static unsigned int requestCount() { return requests; }
+    static unsigned int programCount();
+    static double compileMs() { return compileTimeMs; }
+
+private:
+    // 只保存弱引用，最后一个使用者释放后 ~Shader 删除程序对象（过期的项在下次编译时清理）
+    static std::map<std::string, std::weak_ptr<Shader>> programs;
+    static unsigned int requests;
+    static double compileTimeMs;
+    static std::vector<std::string> globalDefines;
+
+    static std::string makeKey(const std::string &vertexPath, const std::string &geometryPath,
+                               const std::string &fragmentPath, const std::vector<std::string> &defines);
+};
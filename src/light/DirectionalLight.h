@@ -10,12 +10,10 @@ public:
     DirectionalLight(glm::vec3 _direction, glm::vec3 _color)
         : Light(_color), direction(_direction) {}
 
-    // 重写 applyLight()，将平行光的参数传递给着色器
-    void applyLight(Shader &shader, const std::string &lightName) const override
+    // 重写 applyLight()，将平行光的参数写入 LightBlock
+    void applyLight(LightBlock &block) const override
     {
-        shader.use();
-
-        shader.setVec3("uDirLight.direction", direction); // 更新光源方向
-        shader.setVec3("uDirLight.color", color);         // 更新光源颜色
+        block.dirLight.direction = direction; // 更新光源方向
+        block.dirLight.color = color;         // 更新光源颜色
     }
 };
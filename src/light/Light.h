@@ -3,7 +3,7 @@
 #include <glm/glm.hpp>
 #include <string>
 
-#include "../Shader.h"
+#include "../render/UniformBuffers.h"
 
 class Light
 {
@@ -14,7 +14,8 @@ public:
     // 构造函数
     Light(glm::vec3 _color) : color(_color) {}
 
-    virtual void applyLight(Shader& shader, const std::string& lightName) const = 0;
+    // 把光源参数写入每帧共享的 LightBlock
+    virtual void applyLight(LightBlock &block) const = 0;
 
     virtual ~Light() {}
 };
@@ -3,8 +3,16 @@
 #include <iostream>
 #include <vector>
 #include <memory>
+#include <string>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <chrono>
+#include <cfloat>
+#include <algorithm>
 
 #include "Camera.h"
+#include "ShaderLibrary.h"
 
 #include "light/DirectionalLight.h"
 #include "light/PointLight.h"
@@ -15,6 +23,7 @@
 #include "object/Sphere.h"
 #include "object/Cone.h"
 #include "object/Cylinder.h"
+#include "object/MeshArena.h"
 
 #include "material/PhoneMaterial.h"
 #include "material/TexturedPhoneMaterial.h"
@@ -22,9 +31,77 @@
 
 #include "tool/Line.h"
 #include "tool/Point.h"
+#include "tool/FrameStats.h"
+#include "tool/GpuProfiler.h"
+#include "tool/CpuProfiler.h"
+#include "tool/Benchmark.h"
+#include "tool/Screenshot.h"
+#include "tool/HeadlessContext.h"
 
 #include "texture/Texture.h"
 
+#include "render/UniformBuffers.h"
+#include "render/InstanceBatcher.h"
+#include "render/Frustum.h"
+#include "render/ShadowCache.h"
+#include "render/ShadowMoments.h"
+#include "render/ShadowCascades.h"
+#include "render/ShadowAtlas.h"
+#include "render/RenderQueue.h"
+#include "render/GLState.h"
+
+// 点光源阴影立方体贴图的渲染方式
+enum PointShadowMode
+{
+    POINT_SHADOW_MULTIPASS,   // 逐面绑定、逐面提交（6 次）
+    POINT_SHADOW_GEOMETRY,    // 几何着色器把三角形复制到各个面的视口，一次提交
+    POINT_SHADOW_VERTEX_LAYER // 每个物体实例化 6 次，顶点着色器写 gl_ViewportIndex，一次提交
+};
+
+// 运行参数
+struct RunOptions
+{
+    bool headless = false; // 离屏模式：渲染到 FBO，不创建可见窗口
+    int frames = 100;      // 离屏模式渲染的帧数
+    int width = 1024;
+    int height = 1024;
+    std::string bench;     // 非空时只运行对应的微基准测试（需要 --headless）
+    std::string screenshot; // 离屏模式结束时把最后一帧保存为 PPM
+    std::string diffAgainst; // 离屏模式结束时把最后一帧和参考 PPM 比较（--diff-against ref.ppm），不通过时以非零值退出
+    double diffMinPsnr = 40.0;   // 比较通过所需的最低 PSNR（--diff-min-psnr dB）
+    long long diffMaxPixels = -1; // 比较允许的差值超过 Screenshot::DIFF_THRESHOLD 的最多像素数（--diff-max-pixels N），-1 不限制
+    bool instancing = true; // 共享 mesh 的物体合并为实例化绘制（--no-instancing 回退到逐物体绘制）
+    int stressSpheres = 0;  // 额外生成的小球数量，用于测试大量物体时的绘制调用数
+    bool culling = true;    // 主 pass 做视锥体剔除（--no-culling 关闭）
+    PointShadowMode pointShadowMode = POINT_SHADOW_MULTIPASS; // --point-shadow multipass|geometry|vertex-layer
+    bool shadowCache = true;   // 光源和投射物体不变时沿用上一帧的阴影图（--no-shadow-cache 关闭）
+    bool shadowCompare = true; // 阴影图用比较采样器 + 线性过滤（--no-shadow-compare 回到 GL_NEAREST 加手动比较）
+    ShadowFilter shadowFilter = SHADOW_FILTER_PCF; // 阴影过滤方式（--shadow-filter pcf|vsm|evsm）
+    float lightBleed = 0.2f;   // VSM / EVSM 的漏光抑制（--light-bleed 0..1，0 关闭）
+    ShadowQuality shadowQuality = SHADOW_QUALITY_MEDIUM; // 平行光级联阴影的质量预设（--shadow-quality low|medium|high）
+    int cascades = -1;         // 覆盖预设的级联数（--cascades N，0 为以原点为中心的固定单张阴影图），-1 使用预设
+    int cascadeSize = 0;       // 覆盖预设的每级分辨率（--cascade-size N），0 使用预设
+    float cascadeBlend = -1.0f; // 覆盖预设的级联混合比例（--cascade-blend 0..0.5，0 关闭），负数使用预设
+    bool shadowFit = true;     // 阴影投影按投射 / 可见接收物体的包围体拟合（--no-shadow-fit 回到手调的固定范围）
+    unsigned int shadowAtlasSize = 4096; // 阴影图集的边长，即点光源等局部光源阴影图的总预算（--shadow-atlas N）
+    float shadowAtlasScale = 2.0f;       // 光源每覆盖一个屏幕像素分到的阴影图纹素数（--shadow-atlas-scale f）
+    float lightSpeed = 60.0f;  // 点光源绕 Y 轴旋转速度（度/秒），0 表示静止
+    bool animate = false;      // 动态物体绕自身 Y 轴旋转（测试阴影缓存的动态层）
+    bool lod = true;           // 按屏幕投影半径选择球体 / 圆柱 / 圆锥的细分层次（--no-lod 始终使用最精细层次）
+    int shadowLodBias = 1;     // 阴影 pass 在相机选出的层次上再粗糙几级（--shadow-lod-bias N）
+    VertexFormat vertexFormat = VERTEX_FORMAT_SNORM16; // 网格顶点格式（--vertex-format float|half|snorm16）
+    bool depthStreams = true;  // 深度 pass 只读取位置流（--no-depth-streams 绑定完整顶点，用于对比带宽）
+    SortPolicy sortPolicy = SORT_STATE; // 绘制排序策略（--sort-policy none|state|depth）
+    bool zPrepass = false;     // 主 pass 之前先只写深度，光照着色器每个像素只执行一次（--z-prepass）
+    MeshOptimizer::Options meshOptimize; // 网格重排（--no-mesh-opt 关闭，--mesh-opt-overdraw 额外按簇排序减少过度绘制）
+    bool meshArena = true;     // 网格分配在共用的顶点 / 索引缓冲中（--no-mesh-arena 每个网格独立的 VAO）
+    bool multiDraw = true;     // 实例化路径用多重间接绘制提交每个 pass（--no-mdi 关闭，GL 4.3 以下自动回退到逐批绘制）
+    bool gpuProfile = false;   // 每个 pass / 立方体贴图面的 GPU 计时（--gpu-profile，需要以 CG_GPU_PROFILER 构建）
+    std::string gpuProfileCsv; // 离屏模式结束时把每帧的分段计时写成 CSV（--gpu-profile-csv out.csv）
+    std::string cpuTrace;      // CPU 分段计时写成 Chrome trace JSON（--cpu-trace out.json，需要以 CG_CPU_PROFILER 构建）
+};
+bool parseOptions(int argc, char **argv, RunOptions &options);
+
 // 回调函数
 void framebuffer_size_callback(GLFWwindow *window, int width, int height);
 void processInput(GLFWwindow *window, float deltaTime);
@@ -33,10 +110,50 @@ void scroll_callback(GLFWwindow *window, double xoffset, double yoffset);
 
 // create scene objects
 void createSceneObjects(std::vector<std::shared_ptr<Object>> &objects);
+void createStressSpheres(std::vector<std::shared_ptr<Object>> &objects, int count);
+
+// 按剔除结果挑出物体
+void selectObjects(const std::vector<Object *> &objects, const std::vector<unsigned char> &visibility,
+                   std::vector<Object *> &selected);
+
+// 点光源阴影的远平面：到最远的投射物体包围球的距离（向上取整，物体自转时不变）
+float fitPointLightFar(const glm::vec3 &lightPosition, const std::vector<Object *> &casters);
+// 点光源照射范围（以 range 为半径的球）投影到屏幕上的直径（像素），相机在球内时为整个屏幕
+float pointLightCoverage(const glm::mat4 &projection, int width, int height, const glm::vec3 &cameraPosition,
+                         const glm::vec3 &lightPosition, float range);
 
-// settings
-const unsigned int SCR_WIDTH = 1024;
-const unsigned int SCR_HEIGHT = 1024;
+// 当前上下文是否支持某个 OpenGL 扩展
+bool hasExtension(const char *name);
+
+// 点光源阴影的一组投射物体：逐面列表（逐面提交）+ 合并列表和面掩码（分层提交），以及它们在 InstanceBatcher 中的 pass
+struct PointCasterSet
+{
+    std::vector<Object *> faces[6];
+    std::vector<Object *> layered;
+    std::vector<int> masks;
+    int facePasses[6] = {};
+    int layeredPass = 0;
+};
+
+enum CasterFilter
+{
+    CASTERS_ALL,
+    CASTERS_STATIC,
+    CASTERS_DYNAMIC
+};
+
+// 根据每个物体的面掩码整理出一组投射物体
+void buildPointCasterSet(const std::vector<Object *> &objects, const std::vector<int> &faceMasks,
+                         CasterFilter filter, PointCasterSet &set);
+// 把投射物体提交到 InstanceBatcher（facePasses：逐面 pass，layered：分层 pass）
+void addPointCasterPasses(InstanceBatcher &batcher, PointCasterSet &set, bool facePasses, bool layered, int lodBias);
+
+// 阴影图的过滤方式：compare 为 true 时开启深度比较和线性过滤（着色器用 sampler*Shadow 采样），否则为 GL_NEAREST
+void setShadowFiltering(GLenum target, bool compare);
+// 创建阴影图集的深度纹理及其帧缓冲
+void createShadowAtlasMap(unsigned int &texture, unsigned int &fbo, unsigned int size, bool compare);
+// 拷贝阴影图集中第 request 个请求的所有图块的深度（两张图集布局相同）
+void copyShadowAtlasTiles(unsigned int srcFBO, unsigned int dstFBO, const ShadowAtlas &atlas, int request, int tiles);
 
 // camera
 Camera camera(glm::vec3(0.0f, 0.0f, 15.0f), glm::vec3(0.0f, 1.0f, 0.0f), -90.0f, 0.0f);
@@ -45,18 +162,26 @@ bool keys[1024];
 // frame time
 float lastFrame = 0.0f;
 
-// directional light 阴影映射参数
-const unsigned int SHADOW_WIDTH = 1024; // 阴影图分辨率（越大越清晰，性能消耗越高）
-const unsigned int SHADOW_HEIGHT = 1024;
-unsigned int depthMapFBO; // 帧缓冲：用于渲染阴影图
-unsigned int depthMap;    // 深度纹理：存储阴影图
+// directional light 阴影映射参数（分辨率和级联数由 --shadow-quality 预设决定）
+unsigned int depthMapFBO; // 帧缓冲：用于渲染阴影图（逐级附加纹理数组的一层）
+unsigned int depthMap;    // 深度纹理数组：每个级联一层
 
-// point light 阴影参数
-const unsigned int POINT_SHADOW_WIDTH = 2048;
-const unsigned int POINT_SHADOW_HEIGHT = 2048;
-unsigned int pointDepthMap;    // 立方体贴图深度纹理
-unsigned int pointDepthMapFBO; // 帧缓冲（用于渲染6个方向）
-float pointLightFar = 15.0f;   // 点光源视锥体范围（需覆盖场景）
+// point light 阴影参数：立方体的 6 个面各占阴影图集的一个图块，图块大小按光源的屏幕覆盖决定
+unsigned int shadowAtlasMap;    // 阴影图集深度纹理（点光源存 距离 / 远平面）
+unsigned int shadowAtlasFBO;
+unsigned int shadowStaticAtlasMap;    // 阴影缓存：只包含静态投射物体的阴影图集（布局与 shadowAtlasMap 相同）
+unsigned int shadowStaticAtlasFBO;
+const int POINT_SHADOW_REQUEST = 0; // 点光源在阴影图集中的请求序号
+const float POINT_LIGHT_FAR = 15.0f; // 不拟合时的点光源视锥体范围（需覆盖场景）
+
+// 场景最终输出的帧缓冲（窗口模式为默认帧缓冲 0，离屏模式为 offscreenFBO）
+unsigned int mainFBO = 0;
+unsigned int offscreenFBO;
+unsigned int offscreenColorRBO;
+unsigned int offscreenDepthRBO;
+
+// 离屏模式下的固定帧间隔（秒），保证每次运行的光源动画一致
+const float HEADLESS_FRAME_TIME = 1.0f / 60.0f;
 
 // default model
 glm::mat4 model = glm::mat4(1.0f);
@@ -64,53 +189,150 @@ glm::mat4 model = glm::mat4(1.0f);
 // debug mode
 bool debugMode = false;
 
-int main()
+int main(int argc, char **argv)
 {
-    // glfw: initialize and configure
-    // ------------------------------
-    glfwInit();
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 1);
-    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    RunOptions options;
+    if (!parseOptions(argc, argv, options))
+        return -1;
+    // 在创建上下文之前打开，启动阶段的着色器编译和纹理加载也会被记录
+    CpuProfiler::setEnabled(!options.cpuTrace.empty());
 
-#ifdef __APPLE__
-    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+#ifdef CG_HEADLESS_ONLY
+    if (!options.headless)
+    {
+        std::cout << "This build has no window support (glfw not found), run with --headless" << std::endl;
+        return -1;
+    }
+#endif
+
+    auto startupBegin = std::chrono::steady_clock::now();
+
+    // 顶点格式需要在创建任何网格和着色器之前确定
+    MeshCache::setVertexFormat(options.vertexFormat);
+    MeshCache::setOptimizeOptions(options.meshOptimize);
+    MeshCache::setPooled(options.meshArena);
+    if (VertexLayout::get(options.vertexFormat).octahedralNormal())
+        ShaderLibrary::addGlobalDefine("OCTAHEDRAL_NORMAL");
+    if (options.shadowCompare)
+        ShaderLibrary::addGlobalDefine("SHADOW_COMPARE");
+    if (ShadowMoments::define(options.shadowFilter))
+        ShaderLibrary::addGlobalDefine(ShadowMoments::define(options.shadowFilter));
+
+    // 离屏模式优先使用 EGL 上下文（无需显示器），其他平台用隐藏的 glfw 窗口
+#ifdef CG_HAS_EGL
+    HeadlessContext headlessContext;
 #endif
+    FrameStats frameStats;
+    GpuProfiler gpuProfiler;
 
-    // glfw window creation
-    // --------------------
-    GLFWwindow *window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "CG-Project", NULL, NULL);
-    if (window == NULL)
+#ifndef CG_HEADLESS_ONLY
+    GLFWwindow *window = NULL;
+#endif
+    GLADloadproc loadProc = NULL;
+
+#ifdef CG_HAS_EGL
+    if (options.headless)
     {
-        std::cout << "Failed to create GLFW window" << std::endl;
-        glfwTerminate();
-        return -1;
+        if (!headlessContext.create(4, 1))
+            return -1;
+        loadProc = (GLADloadproc)HeadlessContext::getProcAddress;
     }
+#endif
 
-    glfwMakeContextCurrent(window);
-    glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+#ifndef CG_HEADLESS_ONLY
+    if (loadProc == NULL)
+    {
+        // glfw: initialize and configure
+        // ------------------------------
+        glfwInit();
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 1);
+        glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
 
-    // 锁定鼠标到窗口中心
-    // glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);   // 锁定鼠标
-    glfwSetCursorPos(window, SCR_WIDTH / 2.0f, SCR_HEIGHT / 2.0f); // 将光标移动到窗口中心
+#ifdef __APPLE__
+        glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+#endif
+        if (options.headless)
+            glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
 
-    // 设置鼠标输入回调
-    glfwSetCursorPosCallback(window, mouse_callback);
-    glfwSetScrollCallback(window, scroll_callback);
+        // glfw window creation
+        // --------------------
+        window = glfwCreateWindow(options.width, options.height, "CG-Project", NULL, NULL);
+        if (window == NULL)
+        {
+            std::cout << "Failed to create GLFW window" << std::endl;
+            glfwTerminate();
+            return -1;
+        }
+
+        glfwMakeContextCurrent(window);
+        if (!options.headless)
+        {
+            glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+
+            // 锁定鼠标到窗口中心
+            // glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);   // 锁定鼠标
+            glfwSetCursorPos(window, options.width / 2.0f, options.height / 2.0f); // 将光标移动到窗口中心
+
+            // 设置鼠标输入回调
+            glfwSetCursorPosCallback(window, mouse_callback);
+            glfwSetScrollCallback(window, scroll_callback);
+        }
+        else
+        {
+            // 离屏模式不等待垂直同步
+            glfwSwapInterval(0);
+        }
+        loadProc = (GLADloadproc)glfwGetProcAddress;
+    }
+#endif
 
     // glad: load all OpenGL function pointers
     // ---------------------------------------
-    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+    if (!gladLoadGLLoader(loadProc))
     {
         std::cout << "Failed to initialize GLAD" << std::endl;
         return -1;
     }
+    GLState::invalidate();
+
+    if (options.headless)
+    {
+        std::cout << "Renderer: " << glGetString(GL_RENDERER) << " | OpenGL " << glGetString(GL_VERSION) << std::endl;
+
+        // 离屏帧缓冲：颜色 + 深度渲染缓冲，尺寸由 --size 指定
+        glGenRenderbuffers(1, &offscreenColorRBO);
+        glBindRenderbuffer(GL_RENDERBUFFER, offscreenColorRBO);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, options.width, options.height);
+        glGenRenderbuffers(1, &offscreenDepthRBO);
+        glBindRenderbuffer(GL_RENDERBUFFER, offscreenDepthRBO);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, options.width, options.height);
+        glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+        glGenFramebuffers(1, &offscreenFBO);
+        GLState::bindFramebuffer(GL_FRAMEBUFFER, offscreenFBO);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, offscreenColorRBO);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, offscreenDepthRBO);
+        if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+            std::cout << "Offscreen framebuffer is incomplete!" << std::endl;
+        mainFBO = offscreenFBO;
+        GLState::bindFramebuffer(GL_FRAMEBUFFER, mainFBO);
+        GLState::viewport(0, 0, options.width, options.height);
+
+        frameStats.init();
+    }
+    gpuProfiler.setEnabled(options.gpuProfile);
+    gpuProfiler.setPeriodicPrint(!options.headless);
 
     glEnable(GL_DEPTH_TEST);
     glEnable(GL_CULL_FACE);
     if (debugMode)
         glPolygonMode(GL_FRONT_AND_BACK, GL_LINE); // GL_LINE for wireframe mode
 
+    // 每帧共享的 uniform buffer（相机 / 光源 / 阴影 / 材质）
+    UniformBuffers uniformBuffers;
+    uniformBuffers.init();
+
     // 对象初始化
     // -----------
 
@@ -120,7 +342,7 @@ int main()
     // 创建 PointLight（点光源）
     PointLight pointLight(glm::vec3(2.0f, 0.0f, 2.0f), glm::vec3(0.9));
     // 点光源旋转参数
-    float rotationSpeed = 60.0f;                  // 旋转速度（度/秒）
+    float rotationSpeed = options.lightSpeed;     // 旋转速度（度/秒）
     float rotationRadius = pointLight.position.z; // 旋转半径（离Y轴的距离）
     float yHeight = pointLight.position.y;        // 点光源的Y轴高度（旋转时保持不变）
     // 创建 point light 实体
@@ -129,7 +351,61 @@ int main()
 
     // 创建场景物体
     std::vector<std::shared_ptr<Object>> objects;
-    createSceneObjects(objects);
+    {
+        CPU_PROFILE_SCOPE("create scene");
+        createSceneObjects(objects);
+        if (options.stressSpheres > 0)
+            createStressSpheres(objects, options.stressSpheres);
+    }
+
+    // 逐物体绘制时主 pass 的排序（实例化路径由 InstanceBatcher 内部排序）
+    RenderQueue renderQueue;
+    renderQueue.setPolicy(options.sortPolicy);
+    std::vector<Object *> sortedObjects;
+
+    // 实例化分批（所有 pass 的实例数据放在同一个缓冲中）
+    InstanceBatcher instanceBatcher;
+    if (options.instancing)
+    {
+        instanceBatcher.init();
+        instanceBatcher.setDepthStreams(options.depthStreams);
+        instanceBatcher.setSortPolicy(options.sortPolicy);
+
+        // glMultiDrawElementsIndirect 和间接命令中的 baseInstance 需要 GL 4.3（或对应扩展），macOS 的 4.1 上保持逐批绘制
+        GLint glMajor = 0, glMinor = 0;
+        glGetIntegerv(GL_MAJOR_VERSION, &glMajor);
+        glGetIntegerv(GL_MINOR_VERSION, &glMinor);
+        bool multiDrawSupported = glMajor * 10 + glMinor >= 43 ||
+                                  (hasExtension("GL_ARB_multi_draw_indirect") && hasExtension("GL_ARB_base_instance"));
+        if (options.multiDraw && !(multiDrawSupported && instanceBatcher.enableMultiDraw(loadProc)))
+        {
+            std::cout << "Multi-draw indirect needs GL 4.3 or GL_ARB_multi_draw_indirect, falling back to per-batch draws" << std::endl;
+            options.multiDraw = false;
+        }
+    }
+
+    // 视锥体剔除：包围体按 SoA 收集后批量测试
+    std::vector<Object *> sceneObjects;
+    for (auto &obj : objects)
+        sceneObjects.push_back(obj.get());
+    Frustum cameraFrustum;
+    BoundsArray sceneBounds;
+    std::vector<unsigned char> sceneVisibility;
+    std::vector<Object *> visibleObjects;
+
+    // 阴影投射物体剔除：平行光按每个级联的正交体积，点光源按每个面的 90° 视锥体 + 光照范围球
+    Frustum lightFrustum;
+    std::vector<Object *> dirCasters[ShadowCascades::MAX_CASCADES];
+    std::vector<unsigned char> pointInRange;
+    std::vector<unsigned char> faceVisibility;
+    std::vector<int> pointFaceMasks; // 每个物体需要渲染到的立方体贴图面
+    // 开启阴影缓存时静态物体进入缓存层，动态物体每帧合成；关闭时全部在 staticPointCasters 中
+    PointCasterSet staticPointCasters, dynamicPointCasters;
+
+    // 阴影缓存（平行光每个级联一个）
+    ShadowCache dirShadowCaches[ShadowCascades::MAX_CASCADES];
+    ShadowCache pointShadowCache; // 点光源静态层
+    ShadowCache pointMomentCache; // 点光源动态层：动态物体没动时不必重新生成矩图
 
     // 创建point和line对象
     PureColorMaterial pointMaterial(glm::vec3(1.0f, 0.0f, 0.0f));
@@ -141,91 +417,195 @@ int main()
     Line line_y("../shader/default_vertex_shader.vs", "../shader/default_fragment_shader.fs", glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 10.0f, 0.0f), &lineMaterial);
     Line line_z("../shader/default_vertex_shader.vs", "../shader/default_fragment_shader.fs", glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, 10.0f), &lineMaterial);
 
+    // 深度预渲染：只读位置流，片段着色器为空
+    std::shared_ptr<Shader> depthPrepassShader = ShaderLibrary::get("../shader/depth_prepass_vertex_shader.vs", "../shader/shadow_fragment_shader.fs");
+    UniformHandle depthPrepassModelHandle = depthPrepassShader->handle("uModel");
+    std::shared_ptr<Shader> depthPrepassInstancedShader = ShaderLibrary::variant(*depthPrepassShader, "USE_INSTANCING");
+
     // ----- shadow -----
     // directional light 阴影渲染设置
-    Shader shadowShader("../shader/shadow_vertex_shader.vs", "../shader/shadow_fragment_shader.fs"); // 阴影渲染专用着色器
-    // 1. 创建深度纹理（阴影图）
+    std::shared_ptr<Shader> shadowShader = ShaderLibrary::get("../shader/shadow_vertex_shader.vs", "../shader/shadow_fragment_shader.fs"); // 阴影渲染专用着色器
+    UniformHandle shadowModelHandle = shadowShader->handle("uModel");
+    UniformHandle shadowCascadeHandle = shadowShader->handle("uCascade");
+    std::shared_ptr<Shader> shadowInstancedShader = ShaderLibrary::variant(*shadowShader, "USE_INSTANCING");
+    UniformHandle shadowInstancedCascadeHandle = shadowInstancedShader->handle("uCascade");
+
+    // 级联划分：预设决定级联数和分辨率，命令行可以单独覆盖
+    ShadowCascades shadowCascades;
+    {
+        ShadowCascades::Settings cascadeSettings = ShadowCascades::preset(options.shadowQuality);
+        if (options.cascades >= 0)
+            cascadeSettings.count = options.cascades;
+        if (options.cascadeSize > 0)
+            cascadeSettings.resolution = options.cascadeSize;
+        if (options.cascadeBlend >= 0.0f)
+            cascadeSettings.blend = options.cascadeBlend;
+        shadowCascades.configure(cascadeSettings);
+        shadowCascades.setFitting(options.shadowFit);
+    }
+    const unsigned int shadowSize = shadowCascades.settings().resolution; // 每级阴影图的边长
+    const int cascadeLayers = shadowCascades.layers();
+
+    // 1. 创建深度纹理数组（阴影图，每个级联一层）
     glGenTextures(1, &depthMap);
-    glBindTexture(GL_TEXTURE_2D, depthMap);
+    GLState::bindTexture(0, GL_TEXTURE_2D_ARRAY, depthMap);
     // 阴影图只需要深度信息，不需要颜色
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT, SHADOW_WIDTH, SHADOW_HEIGHT, 0, GL_DEPTH_COMPONENT, GL_FLOAT, NULL);
-    // 设置纹理参数：使用 nearest 过滤避免阴影模糊（后期可优化为 PCF 软阴影）
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_DEPTH_COMPONENT, shadowSize, shadowSize, cascadeLayers, 0, GL_DEPTH_COMPONENT, GL_FLOAT, NULL);
+    // 设置纹理参数：比较采样（硬件 2x2 PCF）或 nearest 过滤
+    setShadowFiltering(GL_TEXTURE_2D_ARRAY, options.shadowCompare);
     // 超出阴影图范围的区域视为无阴影（边框颜色设为白色，对应深度1.0）
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
     float borderColor[] = {1.0f, 1.0f, 1.0f, 1.0f};
-    glTexParameterfv(GL_TEXTURE_2D, GL_TEXTURE_BORDER_COLOR, borderColor);
+    glTexParameterfv(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_BORDER_COLOR, borderColor);
 
     // 2. 创建帧缓冲（仅附加深度纹理，不需要颜色缓冲）
     glGenFramebuffers(1, &depthMapFBO);
-    glBindFramebuffer(GL_FRAMEBUFFER, depthMapFBO);
-    // 将深度纹理附加到帧缓冲的深度附着点
-    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, depthMap, 0);
+    GLState::bindFramebuffer(GL_FRAMEBUFFER, depthMapFBO);
+    // 将深度纹理数组的第一层附加到帧缓冲的深度附着点（渲染时逐级切换）
+    glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, depthMap, 0, 0);
     // 关闭颜色缓冲（阴影图只需要深度）
     glDrawBuffer(GL_NONE);
     glReadBuffer(GL_NONE);
     // 检查帧缓冲是否完整
     if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
         std::cout << "Shadow framebuffer is incomplete!" << std::endl;
-    glBindFramebuffer(GL_FRAMEBUFFER, 0); // 解绑帧缓冲
+    GLState::bindFramebuffer(GL_FRAMEBUFFER, 0); // 解绑帧缓冲
 
     // point light 阴影渲染设置
-    Shader pointShadowShader("../shader/point_shadow_vertex_shader.vs", "../shader/point_shadow_fragment_shader.fs"); // 点光源阴影着色器
-    // 1. 初始化点光源阴影的立方体贴图
-    glGenTextures(1, &pointDepthMap);
-    glBindTexture(GL_TEXTURE_CUBE_MAP, pointDepthMap);
-    // 为6个方向（+X,-X,+Y,-Y,+Z,-Z）各创建一个深度纹理
-    for (unsigned int i = 0; i < 6; ++i)
+    std::shared_ptr<Shader> pointShadowShader = ShaderLibrary::get("../shader/point_shadow_vertex_shader.vs", "../shader/point_shadow_fragment_shader.fs"); // 点光源阴影着色器
+    UniformHandle pointShadowModelHandle = pointShadowShader->handle("uModel");
+    UniformHandle pointShadowVPHandle = pointShadowShader->handle("uPointVPMatrix");
+    std::shared_ptr<Shader> pointShadowInstancedShader = ShaderLibrary::variant(*pointShadowShader, "USE_INSTANCING");
+    UniformHandle pointShadowInstancedVPHandle = pointShadowInstancedShader->handle("uPointVPMatrix");
+    // 单次提交的分层渲染（需要实例数据中的面掩码，只支持实例化路径）
+    std::shared_ptr<Shader> pointShadowGeometryShader;
+    std::shared_ptr<Shader> pointShadowVertexLayerShader;
+    UniformHandle pointShadowGeometryVPHandle, pointShadowVertexLayerVPHandle;
+    bool vertexLayerSupported = hasExtension("GL_ARB_shader_viewport_layer_array") || hasExtension("GL_AMD_vertex_shader_viewport_index");
+    bool needLayered = options.pointShadowMode != POINT_SHADOW_MULTIPASS || options.bench == "point-shadow";
+    if (needLayered && options.instancing)
     {
-        glTexImage2D(
-            GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, // 6个方向的纹理目标
-            0,
-            GL_DEPTH_COMPONENT,
-            POINT_SHADOW_WIDTH,
-            POINT_SHADOW_HEIGHT,
-            0,
-            GL_DEPTH_COMPONENT,
-            GL_FLOAT,
-            NULL);
-    }
-    // 2. 设置立方体贴图参数
-    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
-
-    // 3. 初始化点光源阴影的帧缓冲
-    glGenFramebuffers(1, &pointDepthMapFBO);
-    glBindFramebuffer(GL_FRAMEBUFFER, pointDepthMapFBO);
-    // 将立方体贴图附加到帧缓冲的深度附着点
-    glFramebufferTexture(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, pointDepthMap, 0);
-    // 关闭颜色缓冲（只需要深度）
-    glDrawBuffer(GL_NONE);
-    glReadBuffer(GL_NONE);
-    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
-        std::cout << "Point shadow framebuffer incomplete!" << std::endl;
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        pointShadowGeometryShader = ShaderLibrary::get("../shader/point_shadow_vertex_shader.vs", "../shader/point_shadow_geometry_shader.gs",
+                                                       "../shader/point_shadow_fragment_shader.fs", {"USE_INSTANCING", "LAYERED_GEOMETRY"});
+        pointShadowGeometryVPHandle = pointShadowGeometryShader->handle("uPointVPMatrices");
+        if (vertexLayerSupported)
+        {
+            pointShadowVertexLayerShader = ShaderLibrary::variant(*pointShadowInstancedShader, "LAYERED_VERTEX");
+            pointShadowVertexLayerVPHandle = pointShadowVertexLayerShader->handle("uPointVPMatrices");
+        }
+    }
+    if (options.pointShadowMode == POINT_SHADOW_VERTEX_LAYER && !pointShadowVertexLayerShader)
+    {
+        std::cout << "Vertex-layer point shadows need instancing and GL_ARB_shader_viewport_layer_array or GL_AMD_vertex_shader_viewport_index, "
+                  << "falling back to geometry shader" << std::endl;
+        options.pointShadowMode = POINT_SHADOW_GEOMETRY;
+    }
+    if (options.pointShadowMode == POINT_SHADOW_GEOMETRY && !pointShadowGeometryShader)
+    {
+        std::cout << "Layered point shadows need instancing, falling back to multipass" << std::endl;
+        options.pointShadowMode = POINT_SHADOW_MULTIPASS;
+    }
+    ShadowAtlas shadowAtlas;
+    shadowAtlas.setSize(options.shadowAtlasSize);
+    createShadowAtlasMap(shadowAtlasMap, shadowAtlasFBO, options.shadowAtlasSize, options.shadowCompare);
+    if (options.shadowCache)
+        createShadowAtlasMap(shadowStaticAtlasMap, shadowStaticAtlasFBO, options.shadowAtlasSize, options.shadowCompare);
+
+    // VSM / EVSM：阴影图更新后转换成模糊过的矩图，主 pass 采样矩图
+    ShadowMoments shadowMoments;
+    shadowMoments.init(options.shadowFilter, shadowSize, cascadeLayers);
+
+    if (options.bench == "uniforms")
+    {
+        Benchmark::uniforms(*objects[0]->shader, 200000);
+        return 0;
+    }
+
+    if (options.headless)
+    {
+        double startupMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startupBegin).count();
+        std::printf("startup: %.3f ms\n", startupMs);
+        std::printf("shader programs: %u requested, %u in use, %.3f ms compile/link\n",
+                    ShaderLibrary::requestCount(), ShaderLibrary::programCount(), ShaderLibrary::compileMs());
+        std::printf("meshes: %u requested, %u unique, %.2f MB GPU (%.2f MB without sharing), %.3f ms generate/upload\n",
+                    MeshCache::requestCount(), MeshCache::meshCount(), MeshCache::gpuBytes() / (1024.0 * 1024.0),
+                    MeshCache::requestedBytes() / (1024.0 * 1024.0), MeshCache::generateMs());
+        std::printf("vertex format %s: vertices %.2f MB + positions %.2f MB + indices %.2f MB = %.2f MB (float vertices + 32-bit indices: %.2f MB, %.1f%%)\n",
+                    VertexLayout::name(options.vertexFormat), MeshCache::vertexBytes() / (1024.0 * 1024.0),
+                    MeshCache::positionBytes() / (1024.0 * 1024.0), MeshCache::indexBytes() / (1024.0 * 1024.0),
+                    MeshCache::gpuBytes() / (1024.0 * 1024.0),
+                    MeshCache::uncompressedBytes() / (1024.0 * 1024.0),
+                    100.0 * MeshCache::gpuBytes() / std::max(MeshCache::uncompressedBytes(), (size_t)1));
+        const MeshOptimizer::Stats &meshStats = MeshCache::optimizeStats();
+        std::printf("mesh optimization (FIFO %u): ACMR %.3f -> %.3f  ATVR %.3f -> %.3f  (%llu triangles, %.3f ms)\n",
+                    MeshOptimizer::ANALYZE_CACHE_SIZE, meshStats.acmrBefore(), meshStats.acmrAfter(),
+                    meshStats.atvrBefore(), meshStats.atvrAfter(), meshStats.triangles, MeshCache::optimizeMs());
+        std::printf("mesh arena: %.2f MB used / %.2f MB allocated\n",
+                    MeshArena::usedBytes() / (1024.0 * 1024.0), MeshArena::capacityBytes() / (1024.0 * 1024.0));
+        if (shadowCascades.cascaded())
+            std::printf("shadow cascades (%s): %d x %u^2 over %.1f, split lambda %.2f, blend %.2f, %.2f MB\n",
+                        ShadowCascades::name(options.shadowQuality), cascadeLayers, shadowSize, shadowCascades.settings().distance,
+                        shadowCascades.settings().splitLambda, shadowCascades.settings().blend,
+                        (double)shadowSize * shadowSize * cascadeLayers * 4 / (1024.0 * 1024.0));
+        else
+            std::printf("shadow cascades: off, fixed %u^2 map around the origin\n", shadowSize);
+        std::printf("shadow atlas: %u^2, %.2f MB%s\n", options.shadowAtlasSize,
+                    (double)options.shadowAtlasSize * options.shadowAtlasSize * 4 * (options.shadowCache ? 2 : 1) / (1024.0 * 1024.0),
+                    options.shadowCache ? " (with static cache copy)" : "");
+        if (shadowMoments.enabled())
+            std::printf("shadow filter %s: moment maps %.2f MB, light bleed reduction %.2f\n", ShadowMoments::name(options.shadowFilter),
+                        shadowMoments.gpuBytes() / (1024.0 * 1024.0), options.lightBleed);
+        std::printf("objects: %zu, instancing %s, multi-draw indirect %s\n", objects.size(), options.instancing ? "on" : "off",
+                    instanceBatcher.multiDrawEnabled() ? "on" : "off");
+    }
 
     // render loop
     // -----------
-    while (!glfwWindowShouldClose(window))
+    int frameIndex = 0;
+    unsigned int pointMomentSource = 0; // 点光源矩图由哪张阴影图集生成
+    float pointLightFar = POINT_LIGHT_FAR; // 点光源视锥体范围（拟合时每帧更新）
+    float pointCoverage = 0.0f;            // 点光源照射范围的屏幕覆盖（像素）
+    unsigned int pointShadowTileSize = 0;  // 点光源每个面请求的图块边长
+    std::vector<ShadowAtlas::Request> shadowAtlasRequests;
+    while (true)
     {
-        int fbWidth, fbHeight;
-        glfwGetFramebufferSize(window, &fbWidth, &fbHeight);
+        int fbWidth = options.width, fbHeight = options.height;
+        float currentFrame = 0.0f;
+
+        if (options.headless)
+        {
+            if (frameIndex >= options.frames)
+                break;
+            currentFrame = frameIndex * HEADLESS_FRAME_TIME;
+            frameStats.beginFrame();
+        }
+#ifndef CG_HEADLESS_ONLY
+        else
+        {
+            if (glfwWindowShouldClose(window))
+                break;
+            glfwGetFramebufferSize(window, &fbWidth, &fbHeight);
+            currentFrame = glfwGetTime();
+        }
+#endif
+        CPU_PROFILE_SCOPE("frame");
+        gpuProfiler.beginFrame();
 
         // per-frame time logic
         // --------------------
-        float currentFrame = glfwGetTime();
         float deltaTime = currentFrame - lastFrame;
         lastFrame = currentFrame;
 
         // 输入
-        processInput(window, deltaTime);
+        CPU_PROFILE_PHASE(framePhase, "input");
+#ifndef CG_HEADLESS_ONLY
+        if (!options.headless)
+            processInput(window, deltaTime);
+#endif
 
         // 更新点光源位置（绕Y轴旋转）
+        CPU_PROFILE_NEXT(framePhase, "light animation");
         // 计算旋转角度（随时间增加，单位：弧度）
         float angle = glm::radians(rotationSpeed * currentFrame);
         // 绕Y轴旋转的坐标公式：x = r*cos(angle), z = r*sin(angle), y保持不变
@@ -236,42 +616,15 @@ int main()
         modelPointLight = glm::translate(modelPointLight, pointLight.position);
         modelPointLight = glm::scale(modelPointLight, glm::vec3(0.2f, 0.2f, 0.2f));
 
-        // -------------------------- 第一步：渲染阴影图 --------------------------
-        // -------------------------- 渲染平行光阴影图 --------------------------
-        // 1. 计算光源空间矩阵（平行光用正交投影）
-        float near_plane = 1.0f, far_plane = 30.0f; // 光源视锥体范围（覆盖场景）
-        glm::mat4 lightProjection = glm::ortho(-10.0f, 10.0f, -10.0f, 10.0f, near_plane, far_plane);
-        // 光源位置：沿平行光反方向移动一段距离（确保能看到整个场景）
-        glm::mat4 lightView = glm::lookAt(
-            -dirLight.direction * 10.0f, // 光源位置
-            glm::vec3(0.0f, 0.0f, 0.0f), // 看向场景中心
-            glm::vec3(0.0f, 1.0f, 0.0f)  // 上方向
-        );
-        glm::mat4 lightSpaceMatrix = lightProjection * lightView; // 光源空间矩阵
-
-        // 2. 绑定阴影帧缓冲，渲染所有物体到阴影图
-        glViewport(0, 0, SHADOW_WIDTH, SHADOW_HEIGHT); // 设置视口为阴影图大小
-        glBindFramebuffer(GL_FRAMEBUFFER, depthMapFBO);
-        glClear(GL_DEPTH_BUFFER_BIT); // 只清除深度缓冲
-
-        // 使用阴影着色器渲染场景中的物体（需要产生阴影的物体）
-        shadowShader.use();
-        shadowShader.setMat4("uLightSpaceMatrix", lightSpaceMatrix);
-
-        // 渲染平面
-        for (auto &obj : objects)
-        {
-            shadowShader.setMat4("uModel", obj->model);
-            obj->renderVertex();
-        }
-
-        // 解绑阴影帧缓冲，恢复视口为窗口大小
-        glBindFramebuffer(GL_FRAMEBUFFER, 0);
-        glViewport(0, 0, fbWidth, fbHeight);
+        glm::mat4 view = camera.GetViewMatrix();
+        float aspect = (float)fbWidth / (float)fbHeight;
+        glm::mat4 projection = camera.GetProjectionMatrix(aspect);
 
-        // -------------------------- 渲染点光源阴影图（6个方向） --------------------------
-        // 点光源透视投影矩阵（90度FOV，覆盖6个方向）
-        glm::mat4 pointProjection = glm::perspective(glm::radians(90.0f), 1.0f, 0.1f, pointLightFar);
+        LightBlock lightBlock;
+        dirLight.applyLight(lightBlock);
+        pointLight.applyLight(lightBlock);
+        uniformBuffers.updateLights(lightBlock);
+        uniformBuffers.updateMaterials();
 
         // 6个方向的视图矩阵（从点光源位置看向6个轴方向）
         std::vector<glm::mat4> pointViews = {
@@ -283,97 +636,775 @@ int main()
             glm::lookAt(pointLight.position, pointLight.position + glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, -1.0f, 0.0f))  // -Z
         };
 
-        // 绑定点光源阴影帧缓冲，渲染6个方向
-        glViewport(0, 0, POINT_SHADOW_WIDTH, POINT_SHADOW_HEIGHT);
-        glBindFramebuffer(GL_FRAMEBUFFER, pointDepthMapFBO);
-        glClear(GL_DEPTH_BUFFER_BIT);
+        // 动态物体绕自身 Y 轴旋转
+        CPU_PROFILE_NEXT(framePhase, "object animation");
+        if (options.animate)
+        {
+            glm::mat4 spin = glm::rotate(glm::mat4(1.0f), glm::radians(45.0f) * deltaTime, glm::vec3(0.0f, 1.0f, 0.0f));
+            for (Object *obj : sceneObjects)
+            {
+                if (obj->isDynamic())
+                    obj->setModel(obj->getModel() * spin);
+            }
+        }
 
-        // 在逐个方向渲染时，添加VP矩阵传递
-        pointShadowShader.use();
-        pointShadowShader.setVec3("uLightPos", pointLight.position);
-        pointShadowShader.setFloat("uPointLightFar", pointLightFar); // 传递远平面
+        // 细节层次：包围球投影到屏幕上的半径（像素）= 半径 * 焦距 * 半屏高 / 距离；相机在包围球内时用最精细层次
+        // 阴影 pass 也要用到屏幕外的物体，所以对所有物体更新
+        CPU_PROFILE_NEXT(framePhase, "lod");
+        int shadowLodBias = 0;
+        if (options.lod)
+        {
+            float pixelScale = projection[1][1] * 0.5f * (float)fbHeight;
+            for (Object *obj : sceneObjects)
+            {
+                const Bounds &bounds = obj->getWorldBounds();
+                float distance = glm::length(bounds.sphereCenter - camera.position);
+                obj->updateLod(distance > bounds.sphereRadius ? bounds.sphereRadius * pixelScale / distance : FLT_MAX);
+            }
+            shadowLodBias = options.shadowLodBias;
+        }
+
+        // 剔除：相机视锥体决定主 pass 的可见物体（也是阴影投影拟合的接收物体）
+        CPU_PROFILE_NEXT(framePhase, "culling");
+        if (options.culling)
+        {
+            sceneBounds.clear();
+            for (Object *obj : sceneObjects)
+                sceneBounds.add(obj->getWorldBounds());
+
+            cameraFrustum.extract(projection * view);
+            unsigned int visibleCount = cameraFrustum.cull(sceneBounds, sceneVisibility);
+            selectObjects(sceneObjects, sceneVisibility, visibleObjects);
+            FrameStats::addCulling(visibleCount, (unsigned int)sceneObjects.size() - visibleCount);
+        }
+        else
+        {
+            visibleObjects = sceneObjects;
+        }
+
+        // -------------------------- 第一步：渲染阴影图 --------------------------
+        // 1. 计算每个级联的光源空间矩阵（平行光用正交投影，按相机视锥体的切片和物体包围体拟合），
+        //    点光源的远平面取到最远的投射物体
+        CPU_PROFILE_NEXT(framePhase, "shadow fit");
+        shadowCascades.update(view, glm::radians(camera.zoom), aspect, camera.nearPlane, dirLight.direction, sceneObjects, visibleObjects);
+        pointLightFar = options.shadowFit ? fitPointLightFar(pointLight.position, sceneObjects) : POINT_LIGHT_FAR;
+
+        // 阴影图集：点光源每个面的图块边长 = 照射范围的屏幕覆盖 x 每像素纹素数 x 重要性，请求变化时重新排布
+        pointCoverage = pointLightCoverage(projection, fbWidth, fbHeight, camera.position, pointLight.position, pointLightFar);
+        pointShadowTileSize = ShadowAtlas::tileSize(pointCoverage * options.shadowAtlasScale * pointLight.shadowImportance,
+                                                    options.shadowAtlasSize, pointShadowTileSize);
+        shadowAtlasRequests.assign(1, ShadowAtlas::Request{pointShadowTileSize, 6, pointLight.shadowImportance});
+        shadowAtlas.pack(shadowAtlasRequests);
+
+        // 阴影和光源参数每帧只写一次，所有程序通过 uniform block 共享
+        ShadowBlock shadowBlock;
+        shadowCascades.apply(shadowBlock);
+        shadowBlock.pointLightPos = pointLight.position;
+        shadowBlock.pointLightFar = pointLightFar;
+        for (int i = 0; i < 6; ++i)
+            shadowBlock.pointShadowTiles[i] = shadowAtlas.transform(POINT_SHADOW_REQUEST, i);
+        shadowBlock.lightBleedReduction = options.lightBleed;
+        uniformBuffers.updateShadow(shadowBlock);
+
+        // 点光源透视投影矩阵（90度FOV，覆盖6个方向）
+        glm::mat4 pointProjection = glm::perspective(glm::radians(90.0f), 1.0f, 0.1f, pointLightFar);
+
+        // 光源体积决定各阴影 pass 的投射物体
+        CPU_PROFILE_NEXT(framePhase, "shadow culling");
+        pointFaceMasks.assign(sceneObjects.size(), 0x3f);
+        if (options.culling)
+        {
+            // 正交投影的 6 个平面就是每级阴影图覆盖的体积
+            unsigned int casterCount = 0;
+            for (int i = 0; i < cascadeLayers; ++i)
+            {
+                lightFrustum.extract(shadowCascades.matrix(i));
+                casterCount += lightFrustum.cull(sceneBounds, sceneVisibility);
+                selectObjects(sceneObjects, sceneVisibility, dirCasters[i]);
+            }
+
+            Frustum::intersectSphere(sceneBounds, pointLight.position, pointLightFar, pointInRange);
+            for (unsigned int i = 0; i < 6; ++i)
+            {
+                lightFrustum.extract(pointProjection * pointViews[i]);
+                lightFrustum.cull(sceneBounds, faceVisibility);
+                for (size_t j = 0; j < faceVisibility.size(); ++j)
+                {
+                    if (faceVisibility[j] && pointInRange[j])
+                        ++casterCount;
+                    else
+                        pointFaceMasks[j] &= ~(1 << i);
+                }
+            }
+            FrameStats::addShadowCulling(casterCount, (cascadeLayers + 6) * (unsigned int)sceneObjects.size() - casterCount);
+        }
+        else
+        {
+            for (int i = 0; i < cascadeLayers; ++i)
+                dirCasters[i] = sceneObjects;
+        }
+
+        // 点光源投射物体分组：开启缓存时静态物体画进缓存层，动态物体每帧叠加；否则全部每帧重画
+        CPU_PROFILE_NEXT(framePhase, "shadow casters");
+        if (options.shadowCache)
+        {
+            buildPointCasterSet(sceneObjects, pointFaceMasks, CASTERS_STATIC, staticPointCasters);
+            buildPointCasterSet(sceneObjects, pointFaceMasks, CASTERS_DYNAMIC, dynamicPointCasters);
+        }
+        else
+        {
+            buildPointCasterSet(sceneObjects, pointFaceMasks, CASTERS_ALL, staticPointCasters);
+            dynamicPointCasters = PointCasterSet();
+        }
+        bool hasDynamicPointCasters = !dynamicPointCasters.layered.empty();
+
+        // 阴影缓存：光源参数（光源矩阵 / 位置 + 远平面 + 图集布局）和投射物体的变换都没变时沿用上次的阴影图
+        // 级联按纹素对齐，相机不动（或只移动不到一个纹素）时各级的矩阵不变，缓存照样命中
+        unsigned int dirCascadeMask = (1u << cascadeLayers) - 1; // 需要重新渲染的级联
+        bool renderStaticPointShadow = true;
+        // 点光源阴影图存的是到光源的距离，光源一动所有纹素（包括静态物体的）都作废，所以位置必须进签名：
+        // 光源移动时静态层每帧重画，缓存只在光源静止（--light-speed 0）时生效，此时每帧只合成动态物体
+        glm::mat4 pointLightParams(0.0f);
+        pointLightParams[0] = glm::vec4(pointLight.position, pointLightFar);
+        pointLightParams[1][0] = (float)shadowAtlas.generation();
+        if (options.shadowCache)
+        {
+            for (int i = 0; i < cascadeLayers; ++i)
+            {
+                bool renderCascade = dirShadowCaches[i].needsUpdate(shadowCascades.matrix(i), dirCasters[i], shadowLodBias);
+                if (!renderCascade)
+                    dirCascadeMask &= ~(1u << i);
+                FrameStats::addShadowMapUpdate(renderCascade);
+            }
+            renderStaticPointShadow = pointShadowCache.needsUpdate(pointLightParams, staticPointCasters.layered, shadowLodBias);
+            FrameStats::addShadowMapUpdate(renderStaticPointShadow);
+        }
+
+        // 逐物体绘制：按排序键重排主 pass 的可见物体（实例化路径在 InstanceBatcher::addPass 中排序）
+        CPU_PROFILE_NEXT(framePhase, "batching");
+        if (!options.instancing)
+        {
+            renderQueue.setMaxDistance(camera.farPlane);
+            renderQueue.clear();
+            for (Object *obj : visibleObjects)
+            {
+                const Texture *texture = obj->getMaterial()->getDiffuseMap();
+                renderQueue.add(0, obj->shader->ID, texture ? texture->id : 0, obj->getMaterial()->materialIndex + 1,
+                                obj->getLodMesh()->id, RenderQueue::viewDistance(obj->getWorldBounds(), camera.position));
+            }
+            renderQueue.sort();
+            sortedObjects.clear();
+            for (const RenderQueue::Item &item : renderQueue.items())
+                sortedObjects.push_back(visibleObjects[item.index]);
+            visibleObjects.swap(sortedObjects);
+        }
+
+        bool layered = options.pointShadowMode != POINT_SHADOW_MULTIPASS || options.bench == "point-shadow";
+        bool facePasses = options.pointShadowMode == POINT_SHADOW_MULTIPASS || options.bench == "point-shadow";
+        int dirShadowPasses[ShadowCascades::MAX_CASCADES] = {}, prepassPass = 0, mainPass = 0;
+        if (options.instancing)
+        {
+            instanceBatcher.begin();
+            instanceBatcher.setView(camera.position, camera.farPlane);
+            for (int i = 0; i < cascadeLayers; ++i)
+            {
+                if (dirCascadeMask & (1u << i))
+                    dirShadowPasses[i] = instanceBatcher.addPass(dirCasters[i], true, shadowLodBias);
+            }
+            if (renderStaticPointShadow)
+                addPointCasterPasses(instanceBatcher, staticPointCasters, facePasses, layered, shadowLodBias);
+            if (hasDynamicPointCasters)
+                addPointCasterPasses(instanceBatcher, dynamicPointCasters, facePasses, layered, shadowLodBias);
+            if (options.zPrepass)
+                prepassPass = instanceBatcher.addPass(visibleObjects, true);
+            mainPass = instanceBatcher.addPass(visibleObjects, false);
+            instanceBatcher.upload();
+        }
+
+        CPU_PROFILE_NEXT(framePhase, "dir shadow");
+        if (dirCascadeMask)
+        {
+            static const char *const CASCADE_SECTIONS[ShadowCascades::MAX_CASCADES] = {"cascade 0", "cascade 1", "cascade 2", "cascade 3"};
+            GpuProfiler::Scope dirShadowScope(gpuProfiler, "dir shadow");
+
+            // 2. 绑定阴影帧缓冲，逐级把投射物体渲染到阴影图数组的对应层
+            GLState::viewport(0, 0, shadowSize, shadowSize); // 设置视口为阴影图大小
+            GLState::bindFramebuffer(GL_FRAMEBUFFER, depthMapFBO);
+            Shader &activeShadowShader = options.instancing ? *shadowInstancedShader : *shadowShader;
+            activeShadowShader.use();
+            for (int i = 0; i < cascadeLayers; ++i)
+            {
+                if (!(dirCascadeMask & (1u << i)))
+                    continue;
+                GpuProfiler::Scope cascadeScope(gpuProfiler, CASCADE_SECTIONS[i]);
+                glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, depthMap, 0, i);
+                glClear(GL_DEPTH_BUFFER_BIT); // 只清除深度缓冲
+                activeShadowShader.set(options.instancing ? shadowInstancedCascadeHandle : shadowCascadeHandle, i);
+
+                // 使用阴影着色器渲染场景中的物体（需要产生阴影的物体）
+                if (options.instancing)
+                {
+                    // 每个 mesh 一次实例化绘制
+                    instanceBatcher.draw(dirShadowPasses[i]);
+                    continue;
+                }
+                for (Object *obj : dirCasters[i])
+                {
+                    shadowShader->set(shadowModelHandle, obj->getMeshModel(shadowLodBias));
+                    if (options.depthStreams)
+                        obj->renderDepth(shadowLodBias);
+                    else
+                        obj->renderVertex(shadowLodBias);
+                }
+            }
+        }
 
+        // -------------------------- 渲染点光源阴影图（6个方向） --------------------------
+        CPU_PROFILE_NEXT(framePhase, "point shadow");
+        glm::mat4 pointVPMatrices[6];
         for (unsigned int i = 0; i < 6; ++i)
+            pointVPMatrices[i] = pointProjection * pointViews[i];
+
+        // 把一组投射物体渲染到阴影图集 fbo 中点光源 6 个面的图块；clear 为 false 时叠加在已有深度上
+        auto renderPointShadow = [&](PointShadowMode mode, unsigned int fbo, const PointCasterSet &casters, bool clear)
+        {
+            static const char *const FACE_SECTIONS[6] = {"face +X", "face -X", "face +Y", "face -Y", "face +Z", "face -Z"};
+            GpuProfiler::Scope pointShadowScope(gpuProfiler, "point shadow");
+
+            // 裁剪测试把清除和光栅化限制在图块内（图集里还有其他图块，视口之外的保护带不能画进去）
+            // 6 个图块逐个清除（没有投射物体的面也要清除，之后直接跳过）
+            GLState::bindFramebuffer(GL_FRAMEBUFFER, fbo);
+            glEnable(GL_SCISSOR_TEST);
+            if (clear)
+            {
+                for (int i = 0; i < 6; ++i)
+                {
+                    const ShadowAtlas::Tile &tile = shadowAtlas.tile(POINT_SHADOW_REQUEST, i);
+                    glScissor(tile.x, tile.y, tile.size, tile.size);
+                    glClear(GL_DEPTH_BUFFER_BIT);
+                }
+            }
+
+            if (mode == POINT_SHADOW_GEOMETRY || mode == POINT_SHADOW_VERTEX_LAYER)
+            {
+                // 每个面一个视口和裁剪矩形，由 gl_ViewportIndex 选择，所有面一次提交
+                // glViewport 会同时设置所有视口：第 0 个视口经过 GLState，其余的在它之后设置
+                const ShadowAtlas::Tile &first = shadowAtlas.tile(POINT_SHADOW_REQUEST, 0);
+                GLState::viewport(first.x, first.y, first.size, first.size);
+                for (int i = 0; i < 6; ++i)
+                {
+                    const ShadowAtlas::Tile &tile = shadowAtlas.tile(POINT_SHADOW_REQUEST, i);
+                    glViewportIndexedf(i, (float)tile.x, (float)tile.y, (float)tile.size, (float)tile.size);
+                    glScissorIndexed(i, tile.x, tile.y, tile.size, tile.size);
+                }
+                bool geometryMode = mode == POINT_SHADOW_GEOMETRY;
+                Shader &layeredShader = geometryMode ? *pointShadowGeometryShader : *pointShadowVertexLayerShader;
+                layeredShader.use();
+                layeredShader.set(geometryMode ? pointShadowGeometryVPHandle : pointShadowVertexLayerVPHandle, pointVPMatrices, 6);
+                instanceBatcher.draw(casters.layeredPass, mode == POINT_SHADOW_VERTEX_LAYER ? 6 : 1);
+                for (unsigned int i = 0; i < 6; ++i)
+                {
+                    if (casters.faces[i].empty())
+                        FrameStats::addSkippedFace();
+                }
+            }
+            else
+            {
+                // 在逐个方向渲染时，添加VP矩阵传递（光源位置和远平面来自 ShadowBlock）
+                Shader &activePointShadowShader = options.instancing ? *pointShadowInstancedShader : *pointShadowShader;
+                UniformHandle activePointShadowVPHandle = options.instancing ? pointShadowInstancedVPHandle : pointShadowVPHandle;
+                activePointShadowShader.use();
+
+                for (unsigned int i = 0; i < 6; ++i)
+                {
+                    if (casters.faces[i].empty())
+                    {
+                        FrameStats::addSkippedFace();
+                        continue;
+                    }
+                    GpuProfiler::Scope faceScope(gpuProfiler, FACE_SECTIONS[i]);
+
+                    // 视口和裁剪矩形切换到这个面的图块
+                    const ShadowAtlas::Tile &tile = shadowAtlas.tile(POINT_SHADOW_REQUEST, i);
+                    GLState::viewport(tile.x, tile.y, tile.size, tile.size);
+                    glScissor(tile.x, tile.y, tile.size, tile.size);
+
+                    // 传递当前方向的VP矩阵给着色器（关键！否则裁剪错误）
+                    activePointShadowShader.set(activePointShadowVPHandle, pointVPMatrices[i]);
+
+                    // 渲染物体
+                    if (options.instancing)
+                    {
+                        instanceBatcher.draw(casters.facePasses[i]);
+                        continue;
+                    }
+                    for (Object *obj : casters.faces[i])
+                    {
+                        pointShadowShader->set(pointShadowModelHandle, obj->getMeshModel(shadowLodBias));
+                        if (options.depthStreams)
+                            obj->renderDepth(shadowLodBias);
+                        else
+                            obj->renderVertex(shadowLodBias);
+                    }
+                }
+            }
+            glDisable(GL_SCISSOR_TEST);
+        };
+
+        if (options.bench == "point-shadow")
         {
-            glFramebufferTexture2D(
-                GL_FRAMEBUFFER,
-                GL_DEPTH_ATTACHMENT,
-                GL_TEXTURE_CUBE_MAP_POSITIVE_X + i,
-                pointDepthMap,
-                0);
-            glClear(GL_DEPTH_BUFFER_BIT);
-
-            // 计算当前方向的VP矩阵（投影+视图）
-            glm::mat4 pointVPMatrix = pointProjection * pointViews[i];
-            // 传递VP矩阵给着色器（关键！否则裁剪错误）
-            pointShadowShader.setMat4("uPointVPMatrix", pointVPMatrix);
-
-            // 渲染物体
-            for (auto &obj : objects)
+            std::vector<Benchmark::Variant> variants;
+            variants.push_back({"multipass (6 submits)", [&]()
+                                { renderPointShadow(POINT_SHADOW_MULTIPASS, shadowAtlasFBO, staticPointCasters, true); }});
+            if (pointShadowGeometryShader)
+                variants.push_back({"geometry shader layered", [&]()
+                                    { renderPointShadow(POINT_SHADOW_GEOMETRY, shadowAtlasFBO, staticPointCasters, true); }});
+            if (pointShadowVertexLayerShader)
+                variants.push_back({"vertex shader layer", [&]()
+                                    { renderPointShadow(POINT_SHADOW_VERTEX_LAYER, shadowAtlasFBO, staticPointCasters, true); }});
+            unsigned int faceDraws = 0;
+            for (unsigned int i = 0; i < 6; ++i)
+                faceDraws += (unsigned int)staticPointCasters.faces[i].size();
+            std::printf("point shadow casters: %zu objects, %u face draws\n", staticPointCasters.layered.size(), faceDraws);
+            frameStats.endFrame(); // 帧计时查询不能与基准测试的查询嵌套
+            Benchmark::compare("point shadow atlas tiles", variants, options.frames);
+            return 0;
+        }
+
+        // 不开缓存时所有投射物体直接画到最终的阴影图集；
+        // 开启缓存时静态层只在失效时重画，有动态物体时把静态层的图块拷贝到最终图集再叠加动态物体
+        unsigned int sampledPointDepthMap = shadowAtlasMap;
+        if (!options.shadowCache)
+        {
+            renderPointShadow(options.pointShadowMode, shadowAtlasFBO, staticPointCasters, true);
+        }
+        else
+        {
+            if (renderStaticPointShadow)
+                renderPointShadow(options.pointShadowMode, shadowStaticAtlasFBO, staticPointCasters, true);
+            if (hasDynamicPointCasters)
+            {
+                gpuProfiler.begin("point shadow copy");
+                copyShadowAtlasTiles(shadowStaticAtlasFBO, shadowAtlasFBO, shadowAtlas, POINT_SHADOW_REQUEST, 6);
+                gpuProfiler.end();
+                renderPointShadow(options.pointShadowMode, shadowAtlasFBO, dynamicPointCasters, false);
+            }
+            else
             {
-                pointShadowShader.setMat4("uModel", obj->model);
-                obj->renderVertex();
+                sampledPointDepthMap = shadowStaticAtlasMap;
             }
         }
 
-        // 恢复默认帧缓冲和视口
-        glBindFramebuffer(GL_FRAMEBUFFER, 0);
-        glViewport(0, 0, fbWidth, fbHeight);
+        // 矩图只在对应的阴影图变化时重新生成（阴影缓存命中的帧直接沿用）
+        if (shadowMoments.enabled())
+        {
+            if (dirCascadeMask)
+            {
+                GpuProfiler::Scope momentsScope(gpuProfiler, "dir moments");
+                shadowMoments.updateDirectional(depthMap, dirCascadeMask);
+            }
+            bool updatePointMoments = renderStaticPointShadow || sampledPointDepthMap != pointMomentSource;
+            if (hasDynamicPointCasters)
+            {
+                updatePointMoments = pointMomentCache.needsUpdate(pointLightParams, dynamicPointCasters.layered, shadowLodBias) ||
+                                     updatePointMoments;
+            }
+            if (updatePointMoments)
+            {
+                GpuProfiler::Scope momentsScope(gpuProfiler, "point moments");
+                shadowMoments.updatePoint(sampledPointDepthMap, &shadowAtlas.tile(POINT_SHADOW_REQUEST, 0));
+                pointMomentSource = sampledPointDepthMap;
+            }
+        }
 
         // -------------------------- 第二步：正常渲染场景（带阴影） --------------------------
         // render
         // ------
 
+        CPU_PROFILE_NEXT(framePhase, "main pass");
+        // 各阴影 pass 结束时不再恢复帧缓冲和视口，统一在这里切回主帧缓冲（没有渲染阴影时被 GLState 跳过）
+        GLState::bindFramebuffer(GL_FRAMEBUFFER, mainFBO);
+        GLState::viewport(0, 0, fbWidth, fbHeight);
         glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT); // 清除颜色和深度缓冲区
 
-        glm::mat4 view = camera.GetViewMatrix();
-        glm::mat4 projection = camera.GetProjectionMatrix((float)fbWidth / (float)fbHeight);
+        CameraBlock cameraBlock;
+        cameraBlock.view = view;
+        cameraBlock.projection = projection;
+        cameraBlock.viewPos = camera.position;
+        uniformBuffers.updateCamera(cameraBlock);
+
+        // 阴影贴图绑定到固定纹理单元，绑定没有变化的帧由 GLState 跳过
+        GLState::bindTexture(SHADOW_TEXTURE_UNIT, GL_TEXTURE_2D_ARRAY, shadowMoments.enabled() ? shadowMoments.directionalMap() : depthMap);
+        if (shadowMoments.enabled())
+            GLState::bindTexture(POINT_SHADOW_TEXTURE_UNIT, GL_TEXTURE_CUBE_MAP, shadowMoments.pointMap());
+        else
+            GLState::bindTexture(POINT_SHADOW_TEXTURE_UNIT, GL_TEXTURE_2D, sampledPointDepthMap);
+
+        // 深度预渲染：只写深度，之后主 pass 只对最终可见的片段执行光照（深度相等才通过、不再写深度）
+        if (options.zPrepass)
+        {
+            GpuProfiler::Scope prepassScope(gpuProfiler, "z prepass");
+            glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+            if (options.instancing)
+            {
+                depthPrepassInstancedShader->use();
+                instanceBatcher.draw(prepassPass);
+            }
+            else
+            {
+                depthPrepassShader->use();
+                for (Object *obj : visibleObjects)
+                {
+                    depthPrepassShader->set(depthPrepassModelHandle, obj->getMeshModel());
+                    obj->renderDepth();
+                }
+            }
+            glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+        }
 
-        // 渲染点光源立方体
+        // 渲染点光源立方体（不参与预渲染，照常测试和写入深度）
+        gpuProfiler.begin("main pass");
         pointLightCube.render(modelPointLight, view, projection);
 
-        for (auto &obj : objects)
+        if (options.headless)
+            frameStats.beginShadedFragments();
+        if (options.zPrepass)
         {
-            obj->shader->use();
-            obj->shader->setMat4("uLightSpaceMatrix", lightSpaceMatrix);
-            obj->shader->setInt("uShadowMap", 1);
-            glActiveTexture(GL_TEXTURE1);
-            glBindTexture(GL_TEXTURE_2D, depthMap);
+            glDepthFunc(GL_EQUAL);
+            glDepthMask(GL_FALSE);
+        }
 
-            obj->shader->setInt("uPointShadowMap", 2);
-            glActiveTexture(GL_TEXTURE2);
-            glBindTexture(GL_TEXTURE_CUBE_MAP, pointDepthMap);
-            obj->shader->setVec3("uPointLightPos", pointLight.position);
-            obj->shader->setFloat("uPointLightFar", pointLightFar);
+        // 实例化：每个 (mesh, 着色器, 贴图) 一次绘制；否则逐物体上传模型矩阵和材质下标
+        if (options.instancing)
+        {
+            instanceBatcher.draw(mainPass);
+        }
+        else
+        {
+            for (Object *obj : visibleObjects)
+                obj->render(obj->getModel(), view, projection);
+            RenderQueue::StateChanges changes = renderQueue.countStateChanges();
+            FrameStats::addStateChanges(changes.programs, changes.textures, changes.materials, changes.meshes);
+        }
 
-            dirLight.applyLight(*(obj->shader), "dirLight");
-            pointLight.applyLight(*(obj->shader), "pointLight");
-            obj->shader->setVec3("uViewPos", camera.position);
-            obj->render(obj->model, view, projection);
+        if (options.zPrepass)
+        {
+            glDepthFunc(GL_LESS);
+            glDepthMask(GL_TRUE);
         }
+        if (options.headless)
+            frameStats.endShadedFragments();
+        gpuProfiler.end();
 
         // 渲染点和线(debug mode)
         if (debugMode)
         {
-            point.render(model, view, projection);
-            line_x.render(model, view, projection);
-            line_y.render(model, view, projection);
-            line_z.render(model, view, projection);
+            point.render(model);
+            line_x.render(model);
+            line_y.render(model);
+            line_z.render(model);
         }
 
+        CPU_PROFILE_END(framePhase);
+        gpuProfiler.endFrame();
+        if (options.headless)
+        {
+            frameStats.endFrame();
+            ++frameIndex;
+            continue;
+        }
+
+#ifndef CG_HEADLESS_ONLY
         // glfw: swap buffers and poll IO events (keys pressed/released, mouse moved etc.)
         // -------------------------------------------------------------------------------
+        CPU_PROFILE_SCOPE("swap buffers");
         glfwSwapBuffers(window);
         glfwPollEvents();
+#endif
+    }
+
+    int exitCode = 0; // 图像比较不通过时以 1 退出，便于脚本当作回归检查
+    if (options.headless)
+    {
+        frameStats.finish();
+        std::printf("shadow fit %s: dir texel", options.shadowFit ? "on" : "off");
+        for (int i = 0; i < cascadeLayers; ++i)
+            std::printf(" %.4f", shadowCascades.texelSize(i));
+        std::printf(" units, point light far %.2f\n", pointLightFar);
+        std::printf("shadow atlas: point light covers %.0f px, 6 x %u^2 tiles (requested %u^2), %.1f%% of %u^2 used, %u packs\n",
+                    pointCoverage, shadowAtlas.tile(POINT_SHADOW_REQUEST, 0).size, pointShadowTileSize,
+                    shadowAtlas.occupancy() * 100.0f, shadowAtlas.size(), shadowAtlas.generation());
+        gpuProfiler.finish(options.gpuProfileCsv);
+        GLState::printCounters();
+        if (!options.screenshot.empty())
+            Screenshot::save(mainFBO, options.width, options.height, options.screenshot);
+        if (!options.diffAgainst.empty() &&
+            !Screenshot::compare(mainFBO, options.width, options.height, options.diffAgainst, options.diffMinPsnr,
+                                 options.diffMaxPixels))
+            exitCode = 1;
+        GLState::forgetFramebuffer(offscreenFBO);
+        glDeleteFramebuffers(1, &offscreenFBO);
+        glDeleteRenderbuffers(1, &offscreenColorRBO);
+        glDeleteRenderbuffers(1, &offscreenDepthRBO);
     }
 
+    if (!options.cpuTrace.empty() && CpuProfiler::writeChromeTrace(options.cpuTrace))
+        std::printf("cpu trace: %llu events -> %s\n", (unsigned long long)CpuProfiler::eventCount(), options.cpuTrace.c_str());
+
+#ifndef CG_HEADLESS_ONLY
     // glfw: terminate, clearing all previously allocated GLFW resources.
     // ------------------------------------------------------------------
-    glfwTerminate();
-    return 0;
+    if (window != NULL)
+        glfwTerminate();
+#endif
+    return exitCode;
 }
 
+// 解析命令行参数：--headless --frames N --size WxH
+bool parseOptions(int argc, char **argv, RunOptions &options)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        if (arg == "--headless")
+        {
+            options.headless = true;
+        }
+        else if (arg == "--frames" && i + 1 < argc)
+        {
+            options.frames = std::atoi(argv[++i]);
+        }
+        else if (arg == "--size" && i + 1 < argc)
+        {
+            if (std::sscanf(argv[++i], "%dx%d", &options.width, &options.height) != 2)
+            {
+                std::cout << "Invalid --size, expected WxH (e.g. 1024x1024)" << std::endl;
+                return false;
+            }
+        }
+        else if (arg == "--screenshot" && i + 1 < argc)
+        {
+            options.screenshot = argv[++i];
+        }
+        else if (arg == "--diff-against" && i + 1 < argc)
+        {
+            options.diffAgainst = argv[++i];
+        }
+        else if (arg == "--diff-min-psnr" && i + 1 < argc)
+        {
+            options.diffMinPsnr = std::atof(argv[++i]);
+        }
+        else if (arg == "--diff-max-pixels" && i + 1 < argc)
+        {
+            options.diffMaxPixels = std::atoll(argv[++i]);
+        }
+        else if (arg == "--no-instancing")
+        {
+            options.instancing = false;
+        }
+        else if (arg == "--no-culling")
+        {
+            options.culling = false;
+        }
+        else if (arg == "--point-shadow" && i + 1 < argc)
+        {
+            std::string mode = argv[++i];
+            if (mode == "multipass")
+                options.pointShadowMode = POINT_SHADOW_MULTIPASS;
+            else if (mode == "geometry")
+                options.pointShadowMode = POINT_SHADOW_GEOMETRY;
+            else if (mode == "vertex-layer")
+                options.pointShadowMode = POINT_SHADOW_VERTEX_LAYER;
+            else
+            {
+                std::cout << "Invalid --point-shadow, expected multipass, geometry or vertex-layer" << std::endl;
+                return false;
+            }
+        }
+        else if (arg == "--no-shadow-cache")
+        {
+            options.shadowCache = false;
+        }
+        else if (arg == "--no-shadow-compare")
+        {
+            options.shadowCompare = false;
+        }
+        else if (arg == "--shadow-filter" && i + 1 < argc)
+        {
+            if (!ShadowMoments::parse(argv[++i], options.shadowFilter))
+            {
+                std::cout << "Invalid --shadow-filter, expected pcf, vsm or evsm" << std::endl;
+                return false;
+            }
+        }
+        else if (arg == "--light-bleed" && i + 1 < argc)
+        {
+            options.lightBleed = (float)std::atof(argv[++i]);
+        }
+        else if (arg == "--shadow-quality" && i + 1 < argc)
+        {
+            if (!ShadowCascades::parse(argv[++i], options.shadowQuality))
+            {
+                std::cout << "Invalid --shadow-quality, expected low, medium or high" << std::endl;
+                return false;
+            }
+        }
+        else if (arg == "--cascades" && i + 1 < argc)
+        {
+            options.cascades = std::min(std::max(std::atoi(argv[++i]), 0), ShadowCascades::MAX_CASCADES);
+        }
+        else if (arg == "--cascade-size" && i + 1 < argc)
+        {
+            options.cascadeSize = std::max(std::atoi(argv[++i]), 0);
+        }
+        else if (arg == "--cascade-blend" && i + 1 < argc)
+        {
+            options.cascadeBlend = std::min(std::max((float)std::atof(argv[++i]), 0.0f), 0.5f);
+        }
+        else if (arg == "--no-shadow-fit")
+        {
+            options.shadowFit = false;
+        }
+        else if (arg == "--shadow-atlas" && i + 1 < argc)
+        {
+            options.shadowAtlasSize = (unsigned int)std::max(std::atoi(argv[++i]), 0);
+        }
+        else if (arg == "--shadow-atlas-scale" && i + 1 < argc)
+        {
+            options.shadowAtlasScale = std::max((float)std::atof(argv[++i]), 0.0f);
+        }
+        else if (arg == "--light-speed" && i + 1 < argc)
+        {
+            options.lightSpeed = (float)std::atof(argv[++i]);
+        }
+        else if (arg == "--animate")
+        {
+            options.animate = true;
+        }
+        else if (arg == "--no-lod")
+        {
+            options.lod = false;
+        }
+        else if (arg == "--shadow-lod-bias" && i + 1 < argc)
+        {
+            options.shadowLodBias = std::max(std::atoi(argv[++i]), 0);
+        }
+        else if (arg == "--sort-policy" && i + 1 < argc)
+        {
+            if (!RenderQueue::parse(argv[++i], options.sortPolicy))
+            {
+                std::cout << "Invalid --sort-policy, expected none, state or depth" << std::endl;
+                return false;
+            }
+        }
+        else if (arg == "--z-prepass")
+        {
+            options.zPrepass = true;
+        }
+        else if (arg == "--no-mesh-opt")
+        {
+            options.meshOptimize.vertexCache = false;
+            options.meshOptimize.overdraw = false;
+            options.meshOptimize.vertexFetch = false;
+        }
+        else if (arg == "--mesh-opt-overdraw")
+        {
+            options.meshOptimize.overdraw = true;
+        }
+        else if (arg == "--no-depth-streams")
+        {
+            options.depthStreams = false;
+        }
+        else if (arg == "--no-mesh-arena")
+        {
+            options.meshArena = false;
+        }
+        else if (arg == "--no-mdi")
+        {
+            options.multiDraw = false;
+        }
+        else if (arg == "--gpu-profile" || (arg == "--gpu-profile-csv" && i + 1 < argc))
+        {
+#ifndef CG_GPU_PROFILER
+            std::cout << "GPU profiler was compiled out (configure with -DCG_GPU_PROFILER=ON), ignoring " << arg << std::endl;
+#endif
+            options.gpuProfile = true;
+            if (arg == "--gpu-profile-csv")
+                options.gpuProfileCsv = argv[++i];
+        }
+        else if (arg == "--cpu-trace" && i + 1 < argc)
+        {
+#ifndef CG_CPU_PROFILER
+            std::cout << "CPU profiler was compiled out (configure with -DCG_CPU_PROFILER=ON), ignoring " << arg << std::endl;
+            ++i;
+#else
+            options.cpuTrace = argv[++i];
+#endif
+        }
+        else if (arg == "--vertex-format" && i + 1 < argc)
+        {
+            if (!VertexLayout::parse(argv[++i], options.vertexFormat))
+            {
+                std::cout << "Invalid --vertex-format, expected float, half or snorm16" << std::endl;
+                return false;
+            }
+        }
+        else if (arg == "--stress-spheres" && i + 1 < argc)
+        {
+            options.stressSpheres = std::atoi(argv[++i]);
+        }
+        else if (arg == "--bench" && i + 1 < argc)
+        {
+            options.bench = argv[++i];
+        }
+        else
+        {
+            std::cout << "Usage: cg_project [--headless] [--frames N] [--size WxH] [--screenshot out.ppm] [--diff-against ref.ppm] [--diff-min-psnr dB] [--diff-max-pixels N] [--bench uniforms|point-shadow] [--no-instancing] [--no-culling] [--point-shadow multipass|geometry|vertex-layer] [--no-shadow-cache] [--no-shadow-compare] [--shadow-filter pcf|vsm|evsm] [--light-bleed 0..1] [--shadow-quality low|medium|high] [--cascades 0..4] [--cascade-size N] [--cascade-blend 0..0.5] [--no-shadow-fit] [--shadow-atlas N (power of two, 256..16384)] [--shadow-atlas-scale f] [--light-speed deg/s] [--animate] [--no-lod] [--shadow-lod-bias N] [--vertex-format float|half|snorm16] [--no-depth-streams] [--sort-policy none|state|depth] [--z-prepass] [--no-mesh-opt] [--mesh-opt-overdraw] [--no-mesh-arena] [--no-mdi] [--gpu-profile] [--gpu-profile-csv out.csv] [--cpu-trace out.json] [--stress-spheres N]" << std::endl;
+            return false;
+        }
+    }
+
+    if (!options.bench.empty())
+    {
+        if (!options.headless || (options.bench != "uniforms" && options.bench != "point-shadow"))
+        {
+            std::cout << "--bench requires --headless; available benchmarks: uniforms, point-shadow" << std::endl;
+            return false;
+        }
+    }
+
+    // 矩阴影直接读取深度值，阴影图不能开启比较模式
+    if (options.shadowFilter != SHADOW_FILTER_PCF)
+        options.shadowCompare = false;
+
+    // 对比测试需要每次都完整渲染所有投射物体
+    if (options.bench == "point-shadow")
+        options.shadowCache = false;
+
+    // 四叉树按 2 的幂切分，图集至少要放得下点光源 6 个最小图块
+    unsigned int atlasSize = options.shadowAtlasSize;
+    if (atlasSize < ShadowAtlas::MIN_TILE_SIZE * 4 || atlasSize > 16384 || (atlasSize & (atlasSize - 1)) != 0)
+    {
+        std::cout << "--shadow-atlas must be a power of two between " << ShadowAtlas::MIN_TILE_SIZE * 4 << " and 16384" << std::endl;
+        return false;
+    }
+
+    if (options.lightBleed < 0.0f || options.lightBleed >= 1.0f)
+    {
+        std::cout << "--light-bleed must be in [0, 1)" << std::endl;
+        return false;
+    }
+
+    if (options.frames <= 0 || options.width <= 0 || options.height <= 0 || options.stressSpheres < 0)
+    {
+        std::cout << "--frames and --size must be positive, --stress-spheres must not be negative" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+#ifndef CG_HEADLESS_ONLY
 // process all input: query GLFW whether relevant keys are pressed/released this frame and react accordingly
 // ---------------------------------------------------------------------------------------------------------
 void processInput(GLFWwindow *window, float deltaTime)
@@ -414,7 +1445,7 @@ void framebuffer_size_callback(GLFWwindow *window, int width, int height)
 {
     // make sure the viewport matches the new window dimensions; note that width and
     // height will be significantly larger than specified on retina displays.
-    glViewport(0, 0, width, height);
+    GLState::viewport(0, 0, width, height);
 }
 
 // 鼠标输入回调：更新相机的yaw和pitch
@@ -447,6 +1478,7 @@ void scroll_callback(GLFWwindow *window, double xoffset, double yoffset)
 {
     camera.ProcessMouseScroll(yoffset);
 }
+#endif
 
 void createSceneObjects(std::vector<std::shared_ptr<Object>> &objects)
 {
@@ -556,7 +1588,7 @@ void createSceneObjects(std::vector<std::shared_ptr<Object>> &objects)
         m = glm::translate(m, glm::vec3(0.0f, -halfHeight, 0.0f));
         m = glm::rotate(m, glm::radians(-90.0f), glm::vec3(1.0f, 0.0f, 0.0f));
         m = glm::scale(m, glm::vec3(2 * boxSize, 2 * boxSize, 1.0f));
-        floor->model = m;
+        floor->setModel(m);
         objects.push_back(floor);
     }
 
@@ -570,7 +1602,7 @@ void createSceneObjects(std::vector<std::shared_ptr<Object>> &objects)
         m = glm::translate(m, glm::vec3(0.0f, halfHeight, 0.0f));
         m = glm::rotate(m, glm::radians(90.0f), glm::vec3(1.0f, 0.0f, 0.0f));
         m = glm::scale(m, glm::vec3(2 * boxSize, 2 * boxSize, 1.0f));
-        ceiling->model = m;
+        ceiling->setModel(m);
         objects.push_back(ceiling);
     }
 
@@ -584,7 +1616,7 @@ void createSceneObjects(std::vector<std::shared_ptr<Object>> &objects)
         m = glm::translate(m, glm::vec3(-boxSize, 0.0f, 0.0f));
         m = glm::rotate(m, glm::radians(90.0f), glm::vec3(0.0f, 1.0f, 0.0f));
         m = glm::scale(m, glm::vec3(boxHeight, boxHeight, 1.0f));
-        leftWall->model = m;
+        leftWall->setModel(m);
         objects.push_back(leftWall);
     }
 
@@ -598,7 +1630,7 @@ void createSceneObjects(std::vector<std::shared_ptr<Object>> &objects)
         m = glm::translate(m, glm::vec3(boxSize, 0.0f, 0.0f));
         m = glm::rotate(m, glm::radians(-90.0f), glm::vec3(0.0f, 1.0f, 0.0f));
         m = glm::scale(m, glm::vec3(boxHeight, boxHeight, 1.0f));
-        rightWall->model = m;
+        rightWall->setModel(m);
         objects.push_back(rightWall);
     }
 
@@ -611,7 +1643,7 @@ void createSceneObjects(std::vector<std::shared_ptr<Object>> &objects)
         glm::mat4 m(1.0f);
         m = glm::translate(m, glm::vec3(0.0f, 0.0f, -boxSize));
         m = glm::scale(m, glm::vec3(2 * boxSize, boxHeight, 1.0f));
-        backWall->model = m;
+        backWall->setModel(m);
         objects.push_back(backWall);
     }
 
@@ -624,7 +1656,7 @@ void createSceneObjects(std::vector<std::shared_ptr<Object>> &objects)
         glm::mat4 m(1.0f);
         m = glm::translate(m, glm::vec3(0.0f, 0.0f, -boxSize + 0.1f));
         m = glm::scale(m, glm::vec3(3.2f, 2.0f, 1.0f));
-        paintingPlane->model = m;
+        paintingPlane->setModel(m);
         objects.push_back(paintingPlane);
     }
 
@@ -638,7 +1670,7 @@ void createSceneObjects(std::vector<std::shared_ptr<Object>> &objects)
         glm::mat4 m(1.0f);
         m = glm::translate(m, glm::vec3(0.0f, -halfHeight + 1.8f, -boxSize * 0.1f));
         m = glm::scale(m, glm::vec3(0.7f, 1.8f, 0.7f));
-        centerCylinder->model = m;
+        centerCylinder->setModel(m);
         objects.push_back(centerCylinder);
     }
 
@@ -653,7 +1685,7 @@ void createSceneObjects(std::vector<std::shared_ptr<Object>> &objects)
         m = glm::rotate(m, glm::radians(-10.0f), glm::vec3(0.0f, 0.0f, 1.0f));
         m = glm::rotate(m, glm::radians(8.0f), glm::vec3(1.0f, 0.0f, 0.0f));
         m = glm::scale(m, glm::vec3(0.8f, 1.6f, 0.8f));
-        frontLeftCone->model = m;
+        frontLeftCone->setModel(m);
         objects.push_back(frontLeftCone);
     }
 
@@ -666,7 +1698,7 @@ void createSceneObjects(std::vector<std::shared_ptr<Object>> &objects)
         glm::mat4 m(1.0f);
         m = glm::translate(m, glm::vec3(boxSize * 0.6f, -halfHeight + 0.6f, -boxSize * 0.7f));
         m = glm::scale(m, glm::vec3(0.9f, 0.6f, 0.9f));
-        backRightCylinder->model = m;
+        backRightCylinder->setModel(m);
         objects.push_back(backRightCylinder);
     }
 
@@ -679,7 +1711,7 @@ void createSceneObjects(std::vector<std::shared_ptr<Object>> &objects)
         glm::mat4 m(1.0f);
         m = glm::translate(m, glm::vec3(boxSize * 0.8f, -halfHeight + 1.2f, boxSize * 0.5f));
         m = glm::scale(m, glm::vec3(0.5f, 2.0f, 0.5f));
-        frontRightCone->model = m;
+        frontRightCone->setModel(m);
         objects.push_back(frontRightCone);
     }
 
@@ -692,7 +1724,7 @@ void createSceneObjects(std::vector<std::shared_ptr<Object>> &objects)
         glm::mat4 m(1.0f);
         m = glm::translate(m, glm::vec3(-boxSize * 0.4f, -halfHeight + 1.5f, -boxSize * 0.4f));
         m = glm::scale(m, glm::vec3(1.4f, 1.5f, 1.4f));
-        bigBlueCube->model = m;
+        bigBlueCube->setModel(m);
         objects.push_back(bigBlueCube);
     }
 
@@ -706,7 +1738,7 @@ void createSceneObjects(std::vector<std::shared_ptr<Object>> &objects)
         m = glm::translate(m, glm::vec3(boxSize * 0.4f, -halfHeight + 1.0f, -boxSize * 0.1f));
         m = glm::rotate(m, glm::radians(25.0f), glm::vec3(0.0f, 1.0f, 0.0f));
         m = glm::scale(m, glm::vec3(1.0f, 1.0f, 1.0f));
-        tiltedCube->model = m;
+        tiltedCube->setModel(m);
         objects.push_back(tiltedCube);
     }
 
@@ -719,7 +1751,7 @@ void createSceneObjects(std::vector<std::shared_ptr<Object>> &objects)
         glm::mat4 m(1.0f);
         m = glm::translate(m, glm::vec3(-boxSize * 0.2f, -halfHeight + 1.0f, 0.0f));
         m = glm::scale(m, glm::vec3(1.0f, 1.0f, 1.0f));
-        bigPurpleSphere->model = m;
+        bigPurpleSphere->setModel(m);
         objects.push_back(bigPurpleSphere);
     }
 
@@ -732,7 +1764,7 @@ void createSceneObjects(std::vector<std::shared_ptr<Object>> &objects)
         glm::mat4 m(1.0f);
         m = glm::translate(m, glm::vec3(boxSize * 0.1f, -halfHeight + 0.7f, -boxSize * 0.6f));
         m = glm::scale(m, glm::vec3(0.7f, 0.7f, 0.7f));
-        midOrangeSphere->model = m;
+        midOrangeSphere->setModel(m);
         objects.push_back(midOrangeSphere);
     }
 
@@ -745,7 +1777,7 @@ void createSceneObjects(std::vector<std::shared_ptr<Object>> &objects)
         glm::mat4 m(1.0f);
         m = glm::translate(m, glm::vec3(-boxSize * 0.7f, -halfHeight + 0.25f, -boxSize * 0.7f));
         m = glm::scale(m, glm::vec3(0.25f, 0.25f, 0.25f));
-        tinySphere->model = m;
+        tinySphere->setModel(m);
         objects.push_back(tinySphere);
     }
 
@@ -758,7 +1790,8 @@ void createSceneObjects(std::vector<std::shared_ptr<Object>> &objects)
         glm::mat4 m(1.0f);
         m = glm::translate(m, glm::vec3(boxSize * 0.15f, -halfHeight + 1.2f, boxSize * 0.5f));
         m = glm::scale(m, glm::vec3(0.6f, 0.6f, 0.6f));
-        earthSphere->model = m;
+        earthSphere->setModel(m);
+        earthSphere->setDynamic(true); // 地球可以自转（--animate），阴影缓存中作为动态物体
         objects.push_back(earthSphere);
     }
 
@@ -772,7 +1805,7 @@ void createSceneObjects(std::vector<std::shared_ptr<Object>> &objects)
         glm::mat4 m2(1.0f);
         m2 = glm::translate(m2, glm::vec3(-boxSize * 0.8f, -halfHeight + 1.3f, -boxSize * 0.5f));
         m2 = glm::scale(m2, glm::vec3(0.5f, 0.9f, 0.5f));
-        headCone->model = m2;
+        headCone->setModel(m2);
         objects.push_back(headCone);
     }
 
@@ -785,7 +1818,7 @@ void createSceneObjects(std::vector<std::shared_ptr<Object>> &objects)
         glm::mat4 m(1.0f);
         m = glm::translate(m, glm::vec3(-boxSize * 0.5f, -halfHeight + 0.8f, boxSize * 0.6f));
         m = glm::scale(m, glm::vec3(0.9f, 0.7f, 0.9f));
-        woodCube->model = m;
+        woodCube->setModel(m);
         objects.push_back(woodCube);
     }
 
@@ -798,7 +1831,7 @@ void createSceneObjects(std::vector<std::shared_ptr<Object>> &objects)
         glm::mat4 m(1.0f);
         m = glm::translate(m, glm::vec3(-boxSize * 0.2f, -halfHeight + 0.5f, boxSize * 0.9f));
         m = glm::scale(m, glm::vec3(0.4f, 0.4f, 0.4f));
-        smallBlueSphere->model = m;
+        smallBlueSphere->setModel(m);
         objects.push_back(smallBlueSphere);
     }
 
@@ -811,7 +1844,168 @@ void createSceneObjects(std::vector<std::shared_ptr<Object>> &objects)
         glm::mat4 m(1.0f);
         m = glm::translate(m, glm::vec3(boxSize * 0.75f, -halfHeight + 1.0f, boxSize * 0.1f));
         m = glm::scale(m, glm::vec3(0.4f, 1.4f, 0.4f));
-        slimGreenCube->model = m;
+        slimGreenCube->setModel(m);
         objects.push_back(slimGreenCube);
     }
 }
+
+void selectObjects(const std::vector<Object *> &objects, const std::vector<unsigned char> &visibility,
+                   std::vector<Object *> &selected)
+{
+    selected.clear();
+    for (size_t i = 0; i < objects.size(); ++i)
+    {
+        if (visibility[i])
+            selected.push_back(objects[i]);
+    }
+}
+
+void setShadowFiltering(GLenum target, bool compare)
+{
+    // 比较模式下一次采样返回相邻 2x2 个纹素比较结果的双线性插值；参考深度 <= 阴影图深度时为 1（未被遮挡）
+    GLint filter = compare ? GL_LINEAR : GL_NEAREST;
+    glTexParameteri(target, GL_TEXTURE_MIN_FILTER, filter);
+    glTexParameteri(target, GL_TEXTURE_MAG_FILTER, filter);
+    glTexParameteri(target, GL_TEXTURE_COMPARE_MODE, compare ? GL_COMPARE_REF_TO_TEXTURE : GL_NONE);
+    glTexParameteri(target, GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL);
+}
+
+void createShadowAtlasMap(unsigned int &texture, unsigned int &fbo, unsigned int size, bool compare)
+{
+    // 1. 阴影图集的深度纹理（所有图块共用）
+    glGenTextures(1, &texture);
+    GLState::bindTexture(0, GL_TEXTURE_2D, texture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT, size, size, 0, GL_DEPTH_COMPONENT, GL_FLOAT, NULL);
+    // 2. 纹理参数：着色器把坐标限制在图块内，不会读到图集之外
+    setShadowFiltering(GL_TEXTURE_2D, compare);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+    // 3. 帧缓冲（只有深度附着，渲染时由视口 + 裁剪矩形选择图块）
+    glGenFramebuffers(1, &fbo);
+    GLState::bindFramebuffer(GL_FRAMEBUFFER, fbo);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, texture, 0);
+    glDrawBuffer(GL_NONE);
+    glReadBuffer(GL_NONE);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+        std::cout << "Shadow atlas framebuffer incomplete!" << std::endl;
+    GLState::bindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+void copyShadowAtlasTiles(unsigned int srcFBO, unsigned int dstFBO, const ShadowAtlas &atlas, int request, int tiles)
+{
+    GLState::bindFramebuffer(GL_READ_FRAMEBUFFER, srcFBO);
+    GLState::bindFramebuffer(GL_DRAW_FRAMEBUFFER, dstFBO);
+    for (int i = 0; i < tiles; ++i)
+    {
+        const ShadowAtlas::Tile &tile = atlas.tile(request, i);
+        glBlitFramebuffer(tile.x, tile.y, tile.x + tile.size, tile.y + tile.size, tile.x, tile.y, tile.x + tile.size, tile.y + tile.size,
+                          GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+    }
+}
+
+void buildPointCasterSet(const std::vector<Object *> &objects, const std::vector<int> &faceMasks,
+                         CasterFilter filter, PointCasterSet &set)
+{
+    for (unsigned int i = 0; i < 6; ++i)
+        set.faces[i].clear();
+    set.layered.clear();
+    set.masks.clear();
+    for (size_t j = 0; j < objects.size(); ++j)
+    {
+        if (faceMasks[j] == 0)
+            continue;
+        if ((filter == CASTERS_STATIC && objects[j]->isDynamic()) || (filter == CASTERS_DYNAMIC && !objects[j]->isDynamic()))
+            continue;
+        set.layered.push_back(objects[j]);
+        set.masks.push_back(faceMasks[j]);
+        for (unsigned int i = 0; i < 6; ++i)
+        {
+            if (faceMasks[j] & (1 << i))
+                set.faces[i].push_back(objects[j]);
+        }
+    }
+}
+
+void addPointCasterPasses(InstanceBatcher &batcher, PointCasterSet &set, bool facePasses, bool layered, int lodBias)
+{
+    if (facePasses)
+    {
+        for (unsigned int i = 0; i < 6; ++i)
+            set.facePasses[i] = batcher.addPass(set.faces[i], true, lodBias);
+    }
+    if (layered)
+        set.layeredPass = batcher.addPass(set.layered, true, lodBias, set.masks);
+}
+
+float fitPointLightFar(const glm::vec3 &lightPosition, const std::vector<Object *> &casters)
+{
+    // 每个物体取包围球和 AABB 最远点中较近的一个（墙面的 AABB 更紧，旋转的球体的包围球不变）
+    const float step = 0.5f;
+    float farthest = step;
+    for (Object *obj : casters)
+    {
+        const Bounds &bounds = obj->getWorldBounds();
+        float sphereFar = glm::length(bounds.sphereCenter - lightPosition) + bounds.sphereRadius;
+        glm::vec3 corner = glm::max(glm::abs(bounds.aabbMin - lightPosition), glm::abs(bounds.aabbMax - lightPosition));
+        farthest = std::max(farthest, std::min(sphereFar, glm::length(corner)));
+    }
+    return std::ceil(farthest / step) * step;
+}
+
+float pointLightCoverage(const glm::mat4 &projection, int width, int height, const glm::vec3 &cameraPosition,
+                         const glm::vec3 &lightPosition, float range)
+{
+    // 球的视角半径 α：tan α = r / sqrt(d² - r²)，投影半径（像素）= tan α * 焦距 * 半屏高（不考虑偏离视线中心的拉伸）
+    float fullScreen = (float)std::max(width, height);
+    float distance = glm::length(lightPosition - cameraPosition);
+    if (distance <= range)
+        return fullScreen;
+    float tanAngle = range / std::sqrt(distance * distance - range * range);
+    return std::min(2.0f * tanAngle * projection[1][1] * 0.5f * (float)height, fullScreen);
+}
+
+bool hasExtension(const char *name)
+{
+    int count = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+    for (int i = 0; i < count; ++i)
+    {
+        if (std::strcmp((const char *)glGetStringi(GL_EXTENSIONS, i), name) == 0)
+            return true;
+    }
+    return false;
+}
+
+// 在盒子内部按网格排布 count 个低细分小球，所有小球共享同一个 mesh，只用几种材质
+void createStressSpheres(std::vector<std::shared_ptr<Object>> &objects, int count)
+{
+    static PhongMaterial stressMaterials[] = {
+        PhongMaterial(glm::vec3(0.6f, 0.1f, 0.1f), glm::vec3(0.6f, 0.1f, 0.1f), glm::vec3(0.1f, 0.1f, 0.1f), 32.0f),
+        PhongMaterial(glm::vec3(0.1f, 0.6f, 0.1f), glm::vec3(0.1f, 0.6f, 0.1f), glm::vec3(0.1f, 0.1f, 0.1f), 32.0f),
+        PhongMaterial(glm::vec3(0.1f, 0.1f, 0.6f), glm::vec3(0.1f, 0.1f, 0.6f), glm::vec3(0.1f, 0.1f, 0.1f), 32.0f),
+        PhongMaterial(glm::vec3(0.6f, 0.6f, 0.1f), glm::vec3(0.6f, 0.6f, 0.1f), glm::vec3(0.1f, 0.1f, 0.1f), 32.0f)};
+    const int materialCount = sizeof(stressMaterials) / sizeof(stressMaterials[0]);
+
+    int side = 1;
+    while (side * side * side < count)
+        ++side;
+    const float extent = 9.0f; // 盒子内部可用范围
+    const float spacing = extent / side;
+
+    for (int i = 0; i < count; ++i)
+    {
+        int x = i % side, y = (i / side) % side, z = i / (side * side);
+        auto sphere = std::make_shared<Sphere>(
+            "../shader/phone_vertex_shader.vs",
+            "../shader/phone_fragment_shader.fs",
+            &stressMaterials[i % materialCount], 1.0f, 16, 32);
+        glm::mat4 m(1.0f);
+        m = glm::translate(m, glm::vec3(-extent / 2 + (x + 0.5f) * spacing,
+                                        -extent / 2 + (y + 0.5f) * spacing,
+                                        -extent / 2 + (z + 0.5f) * spacing));
+        m = glm::scale(m, glm::vec3(spacing * 0.3f));
+        sphere->setModel(m);
+        objects.push_back(sphere);
+    }
+}
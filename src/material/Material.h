@@ -1,12 +1,24 @@
 #pragma once
 
 #include "../Shader.h"
+#include "../render/UniformBuffers.h"
+
+class Texture;
 
 class Material
 {
 public:
+    // 在 MaterialBlock 中的下标，着色器通过它读取参数（未注册的材质为 -1）
+    int materialIndex = -1;
+
     virtual ~Material() {}
 
     // 把自己对应的 uniform 全部设置到 shader 里
     virtual void applyMaterial(Shader &shader) const = 0;
+
+    // 写入 MaterialBlock 中自己的那一项（只有注册过的材质会被调用）
+    virtual void writeMaterialData(MaterialData &/*data*/) const {}
+
+    // 漫反射贴图（没有时为 nullptr），实例化绘制按贴图分批
+    virtual const Texture *getDiffuseMap() const { return nullptr; }
 };
\ No newline at end of file
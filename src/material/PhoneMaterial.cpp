@@ -1,18 +1,33 @@
 #include "PhoneMaterial.h"
 
+#include <algorithm>
+
 PhongMaterial::PhongMaterial(const glm::vec3 &diffuse,
                              const glm::vec3 &specular,
                              const glm::vec3 &ambient,
                              float shininess)
     : diffuse(diffuse), specular(specular), ambient(ambient), shininess(shininess)
 {
+    materialIndex = UniformBuffers::registerMaterial(this);
+}
+
+PhongMaterial::~PhongMaterial()
+{
+    UniformBuffers::unregisterMaterial(materialIndex, this);
 }
 
 void PhongMaterial::applyMaterial(Shader &shader) const
 {
-    shader.setVec3("uMaterialDiffuse", diffuse);
-    shader.setVec3("uMaterialSpecular", specular);
-    shader.setVec3("uMaterialAmbient", ambient);
-    shader.setFloat("uMaterialShininess", shininess);
-    shader.setInt("uUseDiffuseMap", 0);
+    // 材质参数都在 MaterialBlock 里，每次绘制只需要传下标
+    // 未注册的材质（-1）和实例化绘制一样退回 0 号，避免着色器越界读取
+    shader.set(shader.materialIndexHandle, std::max(materialIndex, 0));
+}
+
+void PhongMaterial::writeMaterialData(MaterialData &data) const
+{
+    data.diffuse = diffuse;
+    data.shininess = shininess;
+    data.specular = specular;
+    data.useDiffuseMap = 0;
+    data.ambient = ambient;
 }
\ No newline at end of file
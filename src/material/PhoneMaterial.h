@@ -16,5 +16,8 @@ public:
                   const glm::vec3 &ambient,
                   float shininess);
 
+    ~PhongMaterial();
+
     void applyMaterial(Shader &shader) const override;
+    void writeMaterialData(MaterialData &data) const override;
 };
\ No newline at end of file
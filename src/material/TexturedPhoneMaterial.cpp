@@ -15,12 +15,15 @@ void TexturedPhongMaterial::applyMaterial(Shader &shader) const
     // 先把 Phong 的基本参数传进去
     PhongMaterial::applyMaterial(shader);
 
-    // 告诉 shader：启用 diffuse 贴图
-    shader.setInt("uUseDiffuseMap", 1);
-
+    // uDiffuseMap 在链接后已固定使用 DIFFUSE_TEXTURE_UNIT
     if (diffuseMap)
-    {
-        diffuseMap->bind(0);             // 绑定到纹理单元 0
-        shader.setInt("uDiffuseMap", 0); // sampler2D 用第 0 个纹理单元
-    }
+        diffuseMap->bind(DIFFUSE_TEXTURE_UNIT);
+}
+
+void TexturedPhongMaterial::writeMaterialData(MaterialData &data) const
+{
+    PhongMaterial::writeMaterialData(data);
+
+    // 告诉 shader：启用 diffuse 贴图
+    data.useDiffuseMap = 1;
 }
\ No newline at end of file
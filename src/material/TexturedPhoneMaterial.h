@@ -15,4 +15,6 @@ public:
                           Texture *diffuseMap);
 
     void applyMaterial(Shader &shader) const override;
+    void writeMaterialData(MaterialData &data) const override;
+    const Texture *getDiffuseMap() const override { return diffuseMap; }
 };
\ No newline at end of file
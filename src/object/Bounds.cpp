@@ -0,0 +1,55 @@
+#include "Bounds.h"
+
+#include <algorithm>
+#include <cmath>
+
+Bounds Bounds::fromVertices(const std::vector<float> &vertices, int stride)
+{
+    Bounds bounds;
+    if (vertices.size() < 3)
+        return bounds;
+
+    glm::vec3 lo(vertices[0], vertices[1], vertices[2]);
+    glm::vec3 hi = lo;
+    for (size_t i = 0; i + 2 < vertices.size(); i += stride)
+    {
+        glm::vec3 p(vertices[i], vertices[i + 1], vertices[i + 2]);
+        lo = glm::min(lo, p);
+        hi = glm::max(hi, p);
+    }
+    bounds.aabbMin = lo;
+    bounds.aabbMax = hi;
+
+    // 包围球以 AABB 中心为球心，半径取到最远顶点的距离（比 AABB 外接球更紧）
+    glm::vec3 center = (lo + hi) * 0.5f;
+    float radius2 = 0.0f;
+    for (size_t i = 0; i + 2 < vertices.size(); i += stride)
+    {
+        glm::vec3 d = glm::vec3(vertices[i], vertices[i + 1], vertices[i + 2]) - center;
+        radius2 = std::max(radius2, glm::dot(d, d));
+    }
+    bounds.sphereCenter = center;
+    bounds.sphereRadius = std::sqrt(radius2);
+    return bounds;
+}
+
+Bounds Bounds::transformed(const glm::mat4 &model) const
+{
+    Bounds result;
+
+    // Arvo 方法：新中心 = M * 中心，新半长 = |M 的 3x3 部分| * 半长
+    glm::vec3 center = (aabbMin + aabbMax) * 0.5f;
+    glm::vec3 extent = (aabbMax - aabbMin) * 0.5f;
+    glm::vec3 worldCenter = glm::vec3(model * glm::vec4(center, 1.0f));
+    glm::vec3 worldExtent(0.0f);
+    for (int column = 0; column < 3; ++column)
+        worldExtent += glm::abs(glm::vec3(model[column])) * extent[column];
+    result.aabbMin = worldCenter - worldExtent;
+    result.aabbMax = worldCenter + worldExtent;
+
+    float scale = std::max(glm::length(glm::vec3(model[0])),
+                           std::max(glm::length(glm::vec3(model[1])), glm::length(glm::vec3(model[2]))));
+    result.sphereCenter = glm::vec3(model * glm::vec4(sphereCenter, 1.0f));
+    result.sphereRadius = sphereRadius * scale;
+    return result;
+}
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <vector>
+
+// 包围体：轴对齐包围盒（AABB）+ 包围球
+struct Bounds
+{
+    glm::vec3 aabbMin = glm::vec3(0.0f);
+    glm::vec3 aabbMax = glm::vec3(0.0f);
+    glm::vec3 sphereCenter = glm::vec3(0.0f);
+    float sphereRadius = 0.0f;
+
+    // 由交错顶点数据（前 3 个 float 为位置）计算局部包围体
+    static Bounds fromVertices(const std::vector<float> &vertices, int stride);
+
+    // 变换到 model 所在空间：AABB 取变换后盒子的外包盒，球半径按最大缩放放大
+    Bounds transformed(const glm::mat4 &model) const;
+};
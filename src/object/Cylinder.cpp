@@ -1,38 +1,33 @@
 #include "Cylinder.h"
+#include "../ShaderLibrary.h"
+#include "../tool/CpuProfiler.h"
+#include <cfloat>
 
 Cylinder::Cylinder(const char *vertexPath, const char *fragmentPath, Material *material,
                    float radius, float height, unsigned int segments)
     : radius(radius), height(height), segments(segments)
 {
-    shader = new Shader(vertexPath, fragmentPath);
+    setShader(ShaderLibrary::get(vertexPath, fragmentPath));
     this->material = material;
-    generateCylinderData();
 
-    glGenVertexArrays(1, &VAO);
-    glGenBuffers(1, &VBO);
-    glGenBuffers(1, &EBO);
-
-    glBindVertexArray(VAO);
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_STATIC_DRAW);
-
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), indices.data(), GL_STATIC_DRAW);
-
-    // 顶点属性配置（与其他形状一致）
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void *)0);
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void *)(3 * sizeof(float)));
-    glEnableVertexAttribArray(1);
-    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void *)(6 * sizeof(float)));
-    glEnableVertexAttribArray(2);
-
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
+    // 相同尺寸和分段数的圆柱共享同一份几何数据
+    // LOD 链：每级把分段数减半，直到低于最小分段数
+    unsigned int levelSegments = segments;
+    do
+    {
+        std::string key = "cylinder r=" + std::to_string(radius) + " h=" + std::to_string(height) + " segments=" + std::to_string(levelSegments);
+        std::shared_ptr<Mesh> levelMesh = MeshCache::get(key, [=](std::vector<float> &vertices, std::vector<unsigned int> &indices)
+                                                         { generateCylinderData(radius, height, levelSegments, vertices, indices); });
+        lods.push_back({levelMesh, lods.empty() ? FLT_MAX : lodMaxScreenRadius(levelSegments)});
+        levelSegments /= 2;
+    } while (levelSegments >= MIN_LOD_SEGMENTS);
+    mesh = lods[0].mesh;
 }
 
-void Cylinder::generateCylinderData()
+void Cylinder::generateCylinderData(float radius, float height, unsigned int segments,
+                                    std::vector<float> &vertices, std::vector<unsigned int> &indices)
 {
+    CPU_PROFILE_FUNCTION();
     vertices.clear();
     indices.clear();
     float halfHeight = height / 2.0f;
@@ -116,18 +111,3 @@ void Cylinder::render(glm::mat4 model, glm::mat4 view, glm::mat4 projection)
     Object::render(model, view, projection);
     renderVertex();
 }
-
-Cylinder::~Cylinder()
-{
-    glDeleteVertexArrays(1, &VAO);
-    glDeleteBuffers(1, &VBO);
-    glDeleteBuffers(1, &EBO);
-    delete shader;
-}
-
-void Cylinder::renderVertex()
-{
-    glBindVertexArray(VAO);
-    glDrawElements(GL_TRIANGLES, indices.size(), GL_UNSIGNED_INT, 0);
-    glBindVertexArray(0);
-}
\ No newline at end of file
@@ -8,15 +8,15 @@ public:
              float radius = 0.5f, float height = 1.0f, unsigned int segments = 36);
 
     void render(glm::mat4 model, glm::mat4 view, glm::mat4 projection) override;
-    ~Cylinder();
-    void renderVertex() override;
 
 private:
+    // LOD 链中最粗糙一级允许的最小分段数
+    static constexpr unsigned int MIN_LOD_SEGMENTS = 8;
+
     float radius;
     float height;
     unsigned int segments;
-    std::vector<float> vertices;
-    std::vector<unsigned int> indices;
 
-    void generateCylinderData();
+    static void generateCylinderData(float radius, float height, unsigned int segments,
+                                     std::vector<float> &vertices, std::vector<unsigned int> &indices);
 };
\ No newline at end of file
@@ -0,0 +1,251 @@
+#include "Mesh.h"
+#include "MeshArena.h"
+#include "../render/GLState.h"
+#include "../tool/FrameStats.h"
+#include "../tool/CpuProfiler.h"
+
+#include <chrono>
+#include <cstddef>
+
+unsigned int Mesh::nextId = 0;
+
+Mesh::Mesh(const std::vector<float> &vertices, const std::vector<unsigned int> &indices, VertexFormat format, bool pooled)
+    : id(nextId++), vertexCount((unsigned int)(vertices.size() / 8)), indexCount((unsigned int)indices.size()), format(format),
+      pooled(false), baseVertex(0), firstIndex(0), VAO(0), VBO(0), EBO(0), depthVAO(0), positionVBO(0)
+{
+    bounds = Bounds::fromVertices(vertices, 8);
+
+    const VertexLayout &layout = VertexLayout::get(format);
+    std::vector<unsigned char> packedVertices = layout.pack(vertices, positionTransform);
+
+    // 顶点数不超过 16 位索引的范围时使用 GL_UNSIGNED_SHORT，索引缓冲减半
+    std::vector<unsigned short> shortIndices;
+    indexType = vertexCount <= 65536 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+    if (indexType == GL_UNSIGNED_SHORT)
+        shortIndices.assign(indices.begin(), indices.end());
+
+    std::vector<unsigned char> positions = layout.extractPositions(packedVertices);
+
+    vertexBytes = packedVertices.size();
+    positionBytes = positions.size();
+    indexBytes = indexType == GL_UNSIGNED_SHORT ? shortIndices.size() * sizeof(unsigned short) : indices.size() * sizeof(unsigned int);
+    gpuBytes = vertexBytes + positionBytes + indexBytes;
+    uncompressedBytes = vertices.size() * sizeof(float) + indices.size() * sizeof(unsigned int);
+
+    // 内存池只保存 16 位索引，顶点更多的网格仍使用自己的缓冲
+    if (pooled && indexType == GL_UNSIGNED_SHORT)
+    {
+        MeshArena::Allocation allocation = MeshArena::allocate(format, packedVertices, positions, shortIndices);
+        this->pooled = true;
+        VAO = allocation.vertexArray;
+        depthVAO = allocation.depthVertexArray;
+        baseVertex = allocation.baseVertex;
+        firstIndex = allocation.firstIndex;
+        return;
+    }
+
+    // 创建 VAO、VBO 和 EBO
+    glGenVertexArrays(1, &VAO);
+    glGenBuffers(1, &VBO);
+    glGenBuffers(1, &EBO);
+
+    GLState::bindVertexArray(VAO);
+
+    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    glBufferData(GL_ARRAY_BUFFER, vertexBytes, packedVertices.data(), GL_STATIC_DRAW);
+
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+    if (indexType == GL_UNSIGNED_SHORT)
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexBytes, shortIndices.data(), GL_STATIC_DRAW);
+    else
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexBytes, indices.data(), GL_STATIC_DRAW);
+
+    // 顶点属性：位置 (location = 0)、法线 (location = 1)、纹理坐标 (location = 2)
+    layout.apply();
+
+    // 深度 VAO：紧凑的位置流 + 同一个索引缓冲
+    glGenVertexArrays(1, &depthVAO);
+    glGenBuffers(1, &positionVBO);
+    GLState::bindVertexArray(depthVAO);
+    glBindBuffer(GL_ARRAY_BUFFER, positionVBO);
+    glBufferData(GL_ARRAY_BUFFER, positionBytes, positions.data(), GL_STATIC_DRAW);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+    layout.applyPositions();
+
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+// 绘制后不再解绑 VAO：所有 VAO 绑定都经过 GLState，下一次绘制同一个 mesh 时可以跳过绑定
+void Mesh::draw() const
+{
+    GLState::bindVertexArray(VAO);
+    glDrawElementsBaseVertex(GL_TRIANGLES, indexCount, indexType, indexOffset(), baseVertex);
+    FrameStats::addDrawCall(indexCount / 3, fetchBytes(false));
+}
+
+void Mesh::drawDepth() const
+{
+    GLState::bindVertexArray(depthVAO);
+    glDrawElementsBaseVertex(GL_TRIANGLES, indexCount, indexType, indexOffset(), baseVertex);
+    FrameStats::addDrawCall(indexCount / 3, fetchBytes(true));
+}
+
+void Mesh::drawInstanced(unsigned int instanceBuffer, unsigned int firstInstance, unsigned int instanceCount,
+                         unsigned int repeat, bool depthOnly) const
+{
+    GLState::bindVertexArray(depthOnly ? depthVAO : VAO);
+    bindInstanceAttributes(instanceBuffer, firstInstance, repeat);
+    glDrawElementsInstancedBaseVertex(GL_TRIANGLES, indexCount, indexType, indexOffset(), instanceCount * repeat, baseVertex);
+    FrameStats::addDrawCall((unsigned long long)indexCount / 3 * instanceCount * repeat, fetchBytes(depthOnly) * instanceCount * repeat);
+}
+
+void Mesh::bindInstanceAttributes(unsigned int instanceBuffer, unsigned int firstInstance, unsigned int divisor)
+{
+    // 实例属性：模型矩阵占 4 个 location（3~6），材质下标和面掩码为整数属性（7、8）
+    size_t base = (size_t)firstInstance * sizeof(InstanceData);
+    glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+    for (int column = 0; column < 4; ++column)
+    {
+        glVertexAttribPointer(3 + column, 4, GL_FLOAT, GL_FALSE, sizeof(InstanceData),
+                              (void *)(base + column * sizeof(glm::vec4)));
+        glEnableVertexAttribArray(3 + column);
+        glVertexAttribDivisor(3 + column, divisor);
+    }
+    glVertexAttribIPointer(7, 1, GL_INT, sizeof(InstanceData), (void *)(base + offsetof(InstanceData, materialIndex)));
+    glEnableVertexAttribArray(7);
+    glVertexAttribDivisor(7, divisor);
+    glVertexAttribIPointer(8, 1, GL_INT, sizeof(InstanceData), (void *)(base + offsetof(InstanceData, faceMask)));
+    glEnableVertexAttribArray(8);
+    glVertexAttribDivisor(8, divisor);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+Mesh::~Mesh()
+{
+    if (pooled)
+        return;
+    GLState::forgetVertexArray(VAO);
+    GLState::forgetVertexArray(depthVAO);
+    glDeleteVertexArrays(1, &VAO);
+    glDeleteVertexArrays(1, &depthVAO);
+    glDeleteBuffers(1, &VBO);
+    glDeleteBuffers(1, &positionVBO);
+    glDeleteBuffers(1, &EBO);
+}
+
+// ---------------------------------- MeshCache ----------------------------------
+
+std::map<std::string, std::weak_ptr<Mesh>> MeshCache::meshes;
+std::map<std::string, size_t> MeshCache::meshRequests;
+unsigned int MeshCache::requests = 0;
+double MeshCache::generateTimeMs = 0.0;
+VertexFormat MeshCache::vertexFormat = VERTEX_FORMAT_FLOAT;
+bool MeshCache::pooled = false;
+MeshOptimizer::Options MeshCache::optimizeOptions;
+MeshOptimizer::Stats MeshCache::optimizationStats;
+double MeshCache::optimizeTimeMs = 0.0;
+
+std::shared_ptr<Mesh> MeshCache::get(const std::string &key, const Generator &generate)
+{
+    ++requests;
+    ++meshRequests[key];
+
+    std::shared_ptr<Mesh> mesh = meshes[key].lock();
+    if (mesh)
+        return mesh;
+
+    CPU_PROFILE_PHASE(meshPhase, "mesh generate");
+    auto begin = std::chrono::steady_clock::now();
+    std::vector<float> vertices;
+    std::vector<unsigned int> indices;
+    generate(vertices, indices);
+
+    CPU_PROFILE_NEXT(meshPhase, "mesh optimize");
+    auto optimizeBegin = std::chrono::steady_clock::now();
+    optimizationStats.add(MeshOptimizer::optimize(vertices, indices, optimizeOptions));
+    optimizeTimeMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - optimizeBegin).count();
+    CPU_PROFILE_NEXT(meshPhase, "mesh upload");
+    mesh = std::make_shared<Mesh>(vertices, indices, vertexFormat, pooled);
+    CPU_PROFILE_END(meshPhase);
+    generateTimeMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+
+    meshes[key] = mesh;
+    return mesh;
+}
+
+unsigned int MeshCache::meshCount()
+{
+    unsigned int count = 0;
+    for (const auto &entry : meshes)
+    {
+        if (!entry.second.expired())
+            ++count;
+    }
+    return count;
+}
+
+size_t MeshCache::gpuBytes()
+{
+    size_t bytes = 0;
+    for (const auto &entry : meshes)
+    {
+        if (std::shared_ptr<Mesh> mesh = entry.second.lock())
+            bytes += mesh->gpuBytes;
+    }
+    return bytes;
+}
+
+size_t MeshCache::requestedBytes()
+{
+    size_t bytes = 0;
+    for (const auto &entry : meshes)
+    {
+        if (std::shared_ptr<Mesh> mesh = entry.second.lock())
+            bytes += mesh->gpuBytes * meshRequests[entry.first];
+    }
+    return bytes;
+}
+
+size_t MeshCache::vertexBytes()
+{
+    size_t bytes = 0;
+    for (const auto &entry : meshes)
+    {
+        if (std::shared_ptr<Mesh> mesh = entry.second.lock())
+            bytes += mesh->vertexBytes;
+    }
+    return bytes;
+}
+
+size_t MeshCache::positionBytes()
+{
+    size_t bytes = 0;
+    for (const auto &entry : meshes)
+    {
+        if (std::shared_ptr<Mesh> mesh = entry.second.lock())
+            bytes += mesh->positionBytes;
+    }
+    return bytes;
+}
+
+size_t MeshCache::indexBytes()
+{
+    size_t bytes = 0;
+    for (const auto &entry : meshes)
+    {
+        if (std::shared_ptr<Mesh> mesh = entry.second.lock())
+            bytes += mesh->indexBytes;
+    }
+    return bytes;
+}
+
+size_t MeshCache::uncompressedBytes()
+{
+    size_t bytes = 0;
+    for (const auto &entry : meshes)
+    {
+        if (std::shared_ptr<Mesh> mesh = entry.second.lock())
+            bytes += mesh->uncompressedBytes;
+    }
+    return bytes;
+}
@@ -0,0 +1,125 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Bounds.h"
+#include "MeshOptimizer.h"
+#include "VertexLayout.h"
+
+// 实例缓冲中每个实例的数据（location 3~6：模型矩阵，location 7：材质下标，location 8：立方体贴图面掩码）
+struct InstanceData
+{
+    glm::mat4 model;
+    int materialIndex;
+    int faceMask; // 分层渲染点光源阴影时需要写入的面（第 i 位对应第 i 个面）
+    int pad[2];
+};
+
+// GPU 上的一份几何数据（VAO/VBO/EBO）
+// 输入统一为交错的 位置(3) + 法线(3) + 纹理坐标(2)，共 8 个 float，上传时按 format 打包（见 VertexLayout）
+// 顶点数少于 65536 时索引使用 16 位
+// 另外保存一份只含位置的紧凑顶点流和对应的深度 VAO（共用索引缓冲），深度 pass 只读取位置
+// pooled 为 true 且索引为 16 位时数据分配在 MeshArena 中，与其他网格共用 VAO，绘制时通过 baseVertex / firstIndex 定位
+class Mesh
+{
+public:
+    Mesh(const std::vector<float> &vertices, const std::vector<unsigned int> &indices,
+         VertexFormat format = VERTEX_FORMAT_FLOAT, bool pooled = false);
+
+    // 绑定 VAO 并按索引绘制
+    void draw() const;
+    // 使用只含位置的深度 VAO 绘制（阴影等只读 location 0 的 pass）
+    void drawDepth() const;
+
+    // 实例化绘制：使用 instanceBuffer 中从 firstInstance 开始的 instanceCount 个 InstanceData
+    // （GL 4.1 没有 baseInstance，通过调整实例属性的偏移实现）
+    // repeat > 1 时每个实例连续绘制 repeat 次（实例属性除数为 repeat），例如逐面分层渲染
+    // depthOnly 为 true 时使用深度 VAO
+    void drawInstanced(unsigned int instanceBuffer, unsigned int firstInstance, unsigned int instanceCount,
+                       unsigned int repeat = 1, bool depthOnly = false) const;
+
+    // 为当前绑定的 VAO 设置实例属性（location 3~8），从 instanceBuffer 的第 firstInstance 个 InstanceData 开始读取
+    static void bindInstanceAttributes(unsigned int instanceBuffer, unsigned int firstInstance, unsigned int divisor);
+
+    unsigned int getVertexArray(bool depthOnly) const { return depthOnly ? depthVAO : VAO; }
+    // 一次绘制引用的顶点和索引数据量（统计带宽用）
+    unsigned long long fetchBytes(bool depthOnly) const { return (depthOnly ? positionBytes : vertexBytes) + indexBytes; }
+
+    ~Mesh();
+
+    unsigned int id; // 创建顺序编号（渲染队列排序键使用）
+    unsigned int vertexCount;
+    unsigned int indexCount;
+    VertexFormat format;
+    GLenum indexType;            // GL_UNSIGNED_SHORT 或 GL_UNSIGNED_INT
+    size_t vertexBytes;          // 顶点缓冲占用的显存
+    size_t positionBytes;        // 位置流占用的显存
+    size_t indexBytes;           // 索引缓冲占用的显存
+    size_t gpuBytes;             // 顶点 + 位置流 + 索引
+    size_t uncompressedBytes;    // 同样的数据用 8 float 顶点 + 32 位索引需要的显存
+    glm::mat4 positionTransform; // 位置反量化矩阵，绘制时乘在模型矩阵右侧（浮点格式为单位矩阵）
+    Bounds bounds;               // 局部空间包围体，生成几何时记录
+    bool pooled;                 // 数据是否在 MeshArena 中（VAO 和缓冲不归自己所有）
+    unsigned int baseVertex;     // 第一个顶点在顶点缓冲中的下标（独立缓冲时为 0）
+    unsigned int firstIndex;     // 第一个索引在索引缓冲中的下标（独立缓冲时为 0）
+
+private:
+    unsigned int VAO, VBO, EBO;
+    unsigned int depthVAO, positionVBO;
+
+    static unsigned int nextId;
+
+    const void *indexOffset() const { return (const void *)((size_t)firstIndex * (indexType == GL_UNSIGNED_SHORT ? 2 : 4)); }
+};
+
+// 网格缓存：按图元类型和生成参数（如 "sphere r=1 stacks=180 slices=360"）共享 Mesh
+// 相同参数的物体引用同一份 GPU 数据，最后一个引用释放时网格随之释放
+class MeshCache
+{
+public:
+    typedef std::function<void(std::vector<float> &vertices, std::vector<unsigned int> &indices)> Generator;
+
+    // 缓存未命中时调用 generate 生成顶点和索引，经 MeshOptimizer 重排后按当前顶点格式上传
+    static std::shared_ptr<Mesh> get(const std::string &key, const Generator &generate);
+
+    // 之后新建的网格使用的优化选项（需在创建物体之前设置）
+    static void setOptimizeOptions(const MeshOptimizer::Options &options) { optimizeOptions = options; }
+    // 所有新建网格的顶点缓存统计（优化前后）
+    static const MeshOptimizer::Stats &optimizeStats() { return optimizationStats; }
+    static double optimizeMs() { return optimizeTimeMs; }
+
+    // 之后新建的网格使用的顶点格式（需在创建物体之前设置）
+    static void setVertexFormat(VertexFormat format) { vertexFormat = format; }
+    static VertexFormat getVertexFormat() { return vertexFormat; }
+
+    // 之后新建的网格是否分配在 MeshArena 中（需在创建物体之前设置）
+    static void setPooled(bool enabled) { pooled = enabled; }
+
+    // 统计信息
+    static unsigned int requestCount() { return requests; }
+    static unsigned int meshCount();
+    static size_t gpuBytes();       // 当前实际占用的显存
+    static size_t requestedBytes(); // 不共享时需要上传的显存（每次请求都算一份）
+    static size_t vertexBytes();       // 顶点缓冲部分
+    static size_t positionBytes();     // 深度 pass 使用的位置流部分
+    static size_t indexBytes();        // 索引缓冲部分
+    static size_t uncompressedBytes(); // 同样的网格用 8 float 顶点 + 32 位索引需要的显存
+    static double generateMs() { return generateTimeMs; }
+
+private:
+    static std::map<std::string, std::weak_ptr<Mesh>> meshes;
+    static std::map<std::string, size_t> meshRequests;
+    static unsigned int requests;
+    static double generateTimeMs;
+    static VertexFormat vertexFormat;
+    static bool pooled;
+    static MeshOptimizer::Options optimizeOptions;
+    static MeshOptimizer::Stats optimizationStats;
+    static double optimizeTimeMs;
+};
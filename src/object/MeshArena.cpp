@@ -0,0 +1,102 @@
+#include "MeshArena.h"
+#include "../render/GLState.h"
+
+#include <algorithm>
+
+MeshArena::Pool MeshArena::pools[MeshArena::FORMAT_COUNT];
+
+bool MeshArena::reserve(Buffer &buffer, size_t bytes)
+{
+    if (buffer.id != 0 && buffer.used + bytes <= buffer.capacity)
+        return false;
+
+    size_t capacity = std::max(buffer.capacity, (size_t)INITIAL_CAPACITY);
+    while (capacity < buffer.used + bytes)
+        capacity *= 2;
+
+    unsigned int id;
+    glGenBuffers(1, &id);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, id);
+    glBufferData(GL_COPY_WRITE_BUFFER, capacity, nullptr, GL_STATIC_DRAW);
+    if (buffer.id != 0)
+    {
+        glBindBuffer(GL_COPY_READ_BUFFER, buffer.id);
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, buffer.used);
+        glBindBuffer(GL_COPY_READ_BUFFER, 0);
+        glDeleteBuffers(1, &buffer.id);
+    }
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+    buffer.id = id;
+    buffer.capacity = capacity;
+    return true;
+}
+
+void MeshArena::setupVertexArrays(const Pool &pool, const VertexLayout &layout)
+{
+    GLState::bindVertexArray(pool.vertexArray);
+    glBindBuffer(GL_ARRAY_BUFFER, pool.vertices.id);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, pool.indices.id);
+    layout.apply();
+
+    GLState::bindVertexArray(pool.depthVertexArray);
+    glBindBuffer(GL_ARRAY_BUFFER, pool.positions.id);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, pool.indices.id);
+    layout.applyPositions();
+
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+MeshArena::Allocation MeshArena::allocate(VertexFormat format, const std::vector<unsigned char> &vertices,
+                                          const std::vector<unsigned char> &positions, const std::vector<unsigned short> &indices)
+{
+    const VertexLayout &layout = VertexLayout::get(format);
+    Pool &pool = pools[format];
+    if (pool.vertexArray == 0)
+    {
+        glGenVertexArrays(1, &pool.vertexArray);
+        glGenVertexArrays(1, &pool.depthVertexArray);
+    }
+
+    size_t indexBytes = indices.size() * sizeof(unsigned short);
+    bool grown = reserve(pool.vertices, vertices.size());
+    grown = reserve(pool.positions, positions.size()) || grown;
+    grown = reserve(pool.indices, indexBytes) || grown;
+    if (grown)
+        setupVertexArrays(pool, layout);
+
+    Allocation allocation;
+    allocation.vertexArray = pool.vertexArray;
+    allocation.depthVertexArray = pool.depthVertexArray;
+    allocation.baseVertex = (unsigned int)(pool.vertices.used / layout.stride);
+    allocation.firstIndex = (unsigned int)(pool.indices.used / sizeof(unsigned short));
+
+    glBindBuffer(GL_COPY_WRITE_BUFFER, pool.vertices.id);
+    glBufferSubData(GL_COPY_WRITE_BUFFER, pool.vertices.used, vertices.size(), vertices.data());
+    glBindBuffer(GL_COPY_WRITE_BUFFER, pool.positions.id);
+    glBufferSubData(GL_COPY_WRITE_BUFFER, pool.positions.used, positions.size(), positions.data());
+    glBindBuffer(GL_COPY_WRITE_BUFFER, pool.indices.id);
+    glBufferSubData(GL_COPY_WRITE_BUFFER, pool.indices.used, indexBytes, indices.data());
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+    pool.vertices.used += vertices.size();
+    pool.positions.used += positions.size();
+    pool.indices.used += indexBytes;
+    return allocation;
+}
+
+size_t MeshArena::capacityBytes()
+{
+    size_t bytes = 0;
+    for (const Pool &pool : pools)
+        bytes += pool.vertices.capacity + pool.positions.capacity + pool.indices.capacity;
+    return bytes;
+}
+
+size_t MeshArena::usedBytes()
+{
+    size_t bytes = 0;
+    for (const Pool &pool : pools)
+        bytes += pool.vertices.used + pool.positions.used + pool.indices.used;
+    return bytes;
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <vector>
+
+#include "VertexLayout.h"
+
+// 网格内存池：同一顶点格式的所有网格共用一个顶点缓冲、一个位置流缓冲和一个 16 位索引缓冲，
+// 以及对应的两个 VAO（完整顶点 / 只含位置），每个网格通过 baseVertex 和索引偏移定位自己的数据
+// 所有网格共用 VAO 后相邻绘制之间不再切换顶点状态，同一批绘制也可以合并成一次多重间接绘制
+// 缓冲不够时容量翻倍（拷贝旧数据并重新设置 VAO）；网格释放后空间不回收（本项目的网格都在启动时创建），
+// 缓冲随上下文一起销毁
+class MeshArena
+{
+public:
+    struct Allocation
+    {
+        unsigned int vertexArray;      // 完整顶点的 VAO
+        unsigned int depthVertexArray; // 只含位置的 VAO
+        unsigned int baseVertex;       // 第一个顶点在内存池中的下标
+        unsigned int firstIndex;       // 第一个索引在内存池中的下标
+    };
+
+    // 追加一个网格：vertices / positions 为按 format 打包好的交错顶点和位置流，
+    // indices 为相对该网格第一个顶点的 16 位索引
+    static Allocation allocate(VertexFormat format, const std::vector<unsigned char> &vertices,
+                               const std::vector<unsigned char> &positions, const std::vector<unsigned short> &indices);
+
+    // 统计信息：各内存池缓冲的总容量和已使用的字节数
+    static size_t capacityBytes();
+    static size_t usedBytes();
+
+private:
+    static const size_t INITIAL_CAPACITY = 1 << 20;
+    static const int FORMAT_COUNT = 3;
+
+    struct Buffer
+    {
+        unsigned int id = 0;
+        size_t capacity = 0;
+        size_t used = 0;
+    };
+
+    struct Pool
+    {
+        unsigned int vertexArray = 0;
+        unsigned int depthVertexArray = 0;
+        Buffer vertices;
+        Buffer positions;
+        Buffer indices;
+    };
+
+    static Pool pools[FORMAT_COUNT];
+
+    // 保证 buffer 至少还能放下 bytes 字节，扩容时返回 true
+    static bool reserve(Buffer &buffer, size_t bytes);
+    // 缓冲重新分配后，把两个 VAO 指向新的缓冲
+    static void setupVertexArrays(const Pool &pool, const VertexLayout &layout);
+};
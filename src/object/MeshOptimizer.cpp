@@ -0,0 +1,286 @@
+#include "MeshOptimizer.h"
+
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    // Forsyth 算法的参数：模拟的 LRU 缓存大小和打分曲线
+    const unsigned int LRU_CACHE_SIZE = 32;
+    const float CACHE_DECAY_POWER = 1.5f;
+    const float LAST_TRIANGLE_SCORE = 0.75f;
+    const float VALENCE_BOOST_SCALE = 2.0f;
+    const float VALENCE_BOOST_POWER = 0.5f;
+
+    // 顶点得分：刚用过的 3 个顶点得固定分，其余按缓存位置衰减；剩余三角形越少得分越高，尽快把顶点用完
+    float vertexScore(int cachePosition, unsigned int remainingTriangles)
+    {
+        if (remainingTriangles == 0)
+            return 0.0f;
+
+        float score = 0.0f;
+        if (cachePosition >= 0)
+        {
+            if (cachePosition < 3)
+                score = LAST_TRIANGLE_SCORE;
+            else
+                score = std::pow(1.0f - (cachePosition - 3) / (float)(LRU_CACHE_SIZE - 3), CACHE_DECAY_POWER);
+        }
+        return score + VALENCE_BOOST_SCALE * std::pow((float)remainingTriangles, -VALENCE_BOOST_POWER);
+    }
+
+    glm::vec3 position(const std::vector<float> &vertices, unsigned int index)
+    {
+        return glm::vec3(vertices[index * 8], vertices[index * 8 + 1], vertices[index * 8 + 2]);
+    }
+}
+
+void MeshOptimizer::Stats::add(const Stats &other)
+{
+    triangles += other.triangles;
+    vertices += other.vertices;
+    transformedBefore += other.transformedBefore;
+    transformedAfter += other.transformedAfter;
+}
+
+MeshOptimizer::Stats MeshOptimizer::optimize(std::vector<float> &vertices, std::vector<unsigned int> &indices, const Options &options)
+{
+    unsigned int vertexCount = (unsigned int)(vertices.size() / 8);
+
+    Stats stats;
+    stats.triangles = indices.size() / 3;
+    stats.transformedBefore = countTransformed(indices, vertexCount);
+
+    if (options.vertexCache)
+        optimizeVertexCache(indices, vertexCount);
+    if (options.overdraw)
+        optimizeOverdraw(vertices, indices, vertexCount);
+    if (options.vertexFetch)
+        optimizeVertexFetch(vertices, indices);
+
+    stats.vertices = vertices.size() / 8;
+    stats.transformedAfter = countTransformed(indices, (unsigned int)(vertices.size() / 8));
+    return stats;
+}
+
+unsigned long long MeshOptimizer::countTransformed(const std::vector<unsigned int> &indices, unsigned int vertexCount,
+                                                   unsigned int cacheSize)
+{
+    // FIFO：记录每个顶点进入缓存时的时间戳，时间差超过缓存大小说明已经被挤出
+    std::vector<unsigned int> timestamps(vertexCount, 0);
+    unsigned int time = cacheSize + 1;
+    unsigned long long transformed = 0;
+    for (unsigned int index : indices)
+    {
+        if (time - timestamps[index] > cacheSize)
+        {
+            timestamps[index] = time++;
+            ++transformed;
+        }
+    }
+    return transformed;
+}
+
+void MeshOptimizer::optimizeVertexCache(std::vector<unsigned int> &indices, unsigned int vertexCount)
+{
+    size_t triangleCount = indices.size() / 3;
+    if (triangleCount == 0)
+        return;
+
+    // 顶点 → 相邻三角形列表（CSR 格式）；每个列表的前 remaining[v] 项是尚未输出的三角形
+    std::vector<unsigned int> remaining(vertexCount, 0);
+    for (unsigned int index : indices)
+        ++remaining[index];
+    std::vector<unsigned int> offsets(vertexCount + 1, 0);
+    for (unsigned int v = 0; v < vertexCount; ++v)
+        offsets[v + 1] = offsets[v] + remaining[v];
+    std::vector<unsigned int> adjacency(indices.size());
+    std::vector<unsigned int> fill(offsets.begin(), offsets.end() - 1);
+    for (size_t i = 0; i < indices.size(); ++i)
+        adjacency[fill[indices[i]]++] = (unsigned int)(i / 3);
+
+    std::vector<int> cachePosition(vertexCount, -1);
+    std::vector<float> scores(vertexCount);
+    for (unsigned int v = 0; v < vertexCount; ++v)
+        scores[v] = vertexScore(-1, remaining[v]);
+
+    std::vector<float> triangleScores(triangleCount);
+    for (size_t t = 0; t < triangleCount; ++t)
+        triangleScores[t] = scores[indices[t * 3]] + scores[indices[t * 3 + 1]] + scores[indices[t * 3 + 2]];
+
+    std::vector<char> emitted(triangleCount, 0);
+    std::vector<unsigned int> output;
+    output.reserve(indices.size());
+    std::vector<unsigned int> cache, newCache;
+    cache.reserve(LRU_CACHE_SIZE + 3);
+    newCache.reserve(LRU_CACHE_SIZE + 3);
+
+    int best = (int)(std::max_element(triangleScores.begin(), triangleScores.end()) - triangleScores.begin());
+    size_t cursor = 0;
+    for (size_t n = 0; n < triangleCount; ++n)
+    {
+        // 缓存中没有可用的三角形（死路）时，按输入顺序取下一个未输出的三角形
+        if (best < 0)
+        {
+            while (emitted[cursor])
+                ++cursor;
+            best = (int)cursor;
+        }
+
+        emitted[best] = 1;
+        const unsigned int *triangle = &indices[best * 3];
+        output.insert(output.end(), triangle, triangle + 3);
+
+        // 从三个顶点的待处理列表中移除该三角形
+        for (int k = 0; k < 3; ++k)
+        {
+            unsigned int v = triangle[k];
+            unsigned int *list = &adjacency[offsets[v]];
+            unsigned int *end = list + remaining[v];
+            unsigned int *it = std::find(list, end, (unsigned int)best);
+            std::swap(*it, *(end - 1));
+            --remaining[v];
+        }
+
+        // 更新 LRU：新三角形的顶点放到最前面，超出缓存大小的被挤出
+        newCache.assign(triangle, triangle + 3);
+        for (unsigned int v : cache)
+        {
+            if (v != triangle[0] && v != triangle[1] && v != triangle[2])
+                newCache.push_back(v);
+        }
+        for (size_t k = 0; k < newCache.size(); ++k)
+        {
+            unsigned int v = newCache[k];
+            cachePosition[v] = k < LRU_CACHE_SIZE ? (int)k : -1;
+
+            // 顶点得分变化后更新其所有未输出三角形的得分
+            float score = vertexScore(cachePosition[v], remaining[v]);
+            float delta = score - scores[v];
+            scores[v] = score;
+            for (unsigned int i = 0; i < remaining[v]; ++i)
+                triangleScores[adjacency[offsets[v] + i]] += delta;
+        }
+        if (newCache.size() > LRU_CACHE_SIZE)
+            newCache.resize(LRU_CACHE_SIZE);
+        cache.swap(newCache);
+
+        // 下一个三角形从缓存中顶点的相邻三角形里选得分最高的
+        best = -1;
+        float bestScore = -1.0f;
+        for (unsigned int v : cache)
+        {
+            for (unsigned int i = 0; i < remaining[v]; ++i)
+            {
+                unsigned int t = adjacency[offsets[v] + i];
+                if (triangleScores[t] > bestScore)
+                {
+                    bestScore = triangleScores[t];
+                    best = (int)t;
+                }
+            }
+        }
+    }
+
+    indices.swap(output);
+}
+
+void MeshOptimizer::optimizeOverdraw(const std::vector<float> &vertices, std::vector<unsigned int> &indices, unsigned int vertexCount)
+{
+    size_t triangleCount = indices.size() / 3;
+    if (triangleCount == 0)
+        return;
+
+    // 在缓存重置点（三个顶点全部未命中）切分成簇，簇内顺序不变，簇之间重排不会明显影响缓存命中率
+    std::vector<size_t> clusterStarts;
+    std::vector<unsigned int> timestamps(vertexCount, 0);
+    unsigned int time = ANALYZE_CACHE_SIZE + 1;
+    for (size_t t = 0; t < triangleCount; ++t)
+    {
+        int misses = 0;
+        for (int k = 0; k < 3; ++k)
+        {
+            unsigned int v = indices[t * 3 + k];
+            if (time - timestamps[v] > ANALYZE_CACHE_SIZE)
+            {
+                timestamps[v] = time++;
+                ++misses;
+            }
+        }
+        if (misses == 3 || t == 0)
+            clusterStarts.push_back(t);
+    }
+    clusterStarts.push_back(triangleCount);
+
+    // 网格中心：按面积加权的三角形重心
+    glm::vec3 meshCenter(0.0f);
+    float meshArea = 0.0f;
+    for (size_t t = 0; t < triangleCount; ++t)
+    {
+        glm::vec3 a = position(vertices, indices[t * 3]), b = position(vertices, indices[t * 3 + 1]), c = position(vertices, indices[t * 3 + 2]);
+        float area = glm::length(glm::cross(b - a, c - a));
+        meshCenter += (a + b + c) * (area / 3.0f);
+        meshArea += area;
+    }
+    if (meshArea > 0.0f)
+        meshCenter /= meshArea;
+
+    // 簇的排序键：簇中心相对网格中心的偏移在簇平均法线上的投影，越朝外的簇越先画，
+    // 先画的外侧表面更容易通过深度测试挡住之后的内侧 / 背面片段
+    struct Cluster
+    {
+        size_t begin, end;
+        float sortKey;
+    };
+    std::vector<Cluster> clusters;
+    for (size_t i = 0; i + 1 < clusterStarts.size(); ++i)
+    {
+        glm::vec3 center(0.0f), normal(0.0f);
+        float area = 0.0f;
+        for (size_t t = clusterStarts[i]; t < clusterStarts[i + 1]; ++t)
+        {
+            glm::vec3 a = position(vertices, indices[t * 3]), b = position(vertices, indices[t * 3 + 1]), c = position(vertices, indices[t * 3 + 2]);
+            glm::vec3 n = glm::cross(b - a, c - a);
+            float triangleArea = glm::length(n);
+            center += (a + b + c) * (triangleArea / 3.0f);
+            normal += n;
+            area += triangleArea;
+        }
+        float key = 0.0f;
+        float normalLength = glm::length(normal);
+        if (area > 0.0f && normalLength > 0.0f)
+            key = glm::dot(center / area - meshCenter, normal / normalLength);
+        clusters.push_back({clusterStarts[i], clusterStarts[i + 1], key});
+    }
+    std::stable_sort(clusters.begin(), clusters.end(), [](const Cluster &a, const Cluster &b)
+                     { return a.sortKey > b.sortKey; });
+
+    std::vector<unsigned int> output;
+    output.reserve(indices.size());
+    for (const Cluster &cluster : clusters)
+        output.insert(output.end(), indices.begin() + cluster.begin * 3, indices.begin() + cluster.end * 3);
+    indices.swap(output);
+}
+
+void MeshOptimizer::optimizeVertexFetch(std::vector<float> &vertices, std::vector<unsigned int> &indices)
+{
+    // 顶点按第一次被引用的顺序排列，相邻三角形读取的顶点在内存中也相邻
+    const unsigned int UNUSED = ~0u;
+    std::vector<unsigned int> remap(vertices.size() / 8, UNUSED);
+    unsigned int next = 0;
+    for (unsigned int &index : indices)
+    {
+        if (remap[index] == UNUSED)
+            remap[index] = next++;
+        index = remap[index];
+    }
+
+    std::vector<float> output((size_t)next * 8);
+    for (size_t v = 0; v < remap.size(); ++v)
+    {
+        if (remap[v] != UNUSED)
+            std::copy(vertices.begin() + v * 8, vertices.begin() + v * 8 + 8, output.begin() + (size_t)remap[v] * 8);
+    }
+    vertices.swap(output);
+}
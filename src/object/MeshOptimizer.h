@@ -0,0 +1,49 @@
+#pragma once
+
+#include <vector>
+
+// 网格预处理：在上传之前重排索引和顶点，提高 GPU 变换后顶点缓存命中率和顶点读取的局部性
+//  1. 顶点缓存优化（Forsyth 线性时间算法，模拟 LRU 缓存给三角形打分，贪心地选下一个三角形）
+//  2. 可选的减少过度绘制：按缓存重置点把三角形序列切成簇，朝外的簇排在前面（Tipsify 的簇排序）
+//  3. 顶点读取优化：按索引中第一次出现的顺序重排顶点，去掉未被引用的顶点
+// 输入输出均为 8 float 交错顶点 + 32 位索引
+class MeshOptimizer
+{
+public:
+    struct Options
+    {
+        bool vertexCache = true;
+        bool overdraw = false;
+        bool vertexFetch = true;
+    };
+
+    // 顶点缓存统计（FIFO 缓存模拟）：
+    // ACMR = 变换的顶点数 / 三角形数（越小越好，理想值约 0.5），ATVR = 变换的顶点数 / 顶点数（理想值 1）
+    struct Stats
+    {
+        unsigned long long triangles = 0;
+        unsigned long long vertices = 0;
+        unsigned long long transformedBefore = 0;
+        unsigned long long transformedAfter = 0;
+
+        void add(const Stats &other);
+        double acmrBefore() const { return triangles ? (double)transformedBefore / triangles : 0.0; }
+        double acmrAfter() const { return triangles ? (double)transformedAfter / triangles : 0.0; }
+        double atvrBefore() const { return vertices ? (double)transformedBefore / vertices : 0.0; }
+        double atvrAfter() const { return vertices ? (double)transformedAfter / vertices : 0.0; }
+    };
+
+    // 统计时模拟的 FIFO 缓存大小
+    static const unsigned int ANALYZE_CACHE_SIZE = 16;
+
+    static Stats optimize(std::vector<float> &vertices, std::vector<unsigned int> &indices, const Options &options);
+
+    // 模拟 FIFO 顶点缓存，返回需要变换的顶点数
+    static unsigned long long countTransformed(const std::vector<unsigned int> &indices, unsigned int vertexCount,
+                                               unsigned int cacheSize = ANALYZE_CACHE_SIZE);
+
+private:
+    static void optimizeVertexCache(std::vector<unsigned int> &indices, unsigned int vertexCount);
+    static void optimizeOverdraw(const std::vector<float> &vertices, std::vector<unsigned int> &indices, unsigned int vertexCount);
+    static void optimizeVertexFetch(std::vector<float> &vertices, std::vector<unsigned int> &indices);
+};
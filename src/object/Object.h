@@ -3,9 +3,13 @@
 #include <glad/glad.h>
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
+#include <algorithm>
+#include <memory>
+#include <vector>
 
 #include "../Shader.h"
 #include "../material/Material.h"
+#include "Mesh.h"
 
 class Object
 {
@@ -17,18 +21,105 @@ public:
         // 应用材质
         material->applyMaterial(*shader);
 
-        // 传递模型、视图和投影矩阵到着色器
-        shader->setMat4("uModel", model);
-        shader->setMat4("uView", view);
-        shader->setMat4("uProjection", projection);
+        // 传递模型矩阵到着色器（右乘网格的位置反量化矩阵）；视图和投影矩阵一般来自 CameraBlock，
+        // 只有仍然声明了普通 uniform 的着色器才需要逐物体设置
+        shader->set(uModelHandle, model * getLodMesh()->positionTransform);
+        if (uViewHandle.valid())
+            shader->set(uViewHandle, view);
+        if (uProjectionHandle.valid())
+            shader->set(uProjectionHandle, projection);
     }
-    virtual void renderVertex() = 0;
+    // 只提交几何（阴影等 pass 使用，由调用方负责着色器）
+    // lodBias 在当前细节层次上再粗糙几级（阴影 pass 使用）
+    virtual void renderVertex(int lodBias = 0)
+    {
+        getLodMesh(lodBias)->draw();
+    }
+    // 只提交位置流（深度 pass 使用）
+    void renderDepth(int lodBias = 0)
+    {
+        getLodMesh(lodBias)->drawDepth();
+    }
+
+    virtual ~Object() {}
+
+    std::shared_ptr<Shader> shader; // 由 ShaderLibrary 共享
+    std::shared_ptr<Mesh> mesh;     // 由 MeshCache 共享
+
+    // 模型矩阵只能通过 setModel 修改，以便同步更新世界空间包围体
+    void setModel(const glm::mat4 &_model)
+    {
+        model = _model;
+        worldBounds = mesh->bounds.transformed(model);
+        ++transformVersion;
+    }
+    const glm::mat4 &getModel() const { return model; }
+    const Bounds &getWorldBounds() const { return worldBounds; }
+    // 每次 setModel 加一，阴影缓存据此判断投射物体是否移动过
+    unsigned int getTransformVersion() const { return transformVersion; }
+
+    // 动态物体（可能逐帧移动）不进入点光源阴影的静态缓存层
+    void setDynamic(bool _dynamic) { dynamic = _dynamic; }
+    bool isDynamic() const { return dynamic; }
+
+    Material *getMaterial() const { return material; }
+
+    // 细节层次（LOD）：根据包围球投影到屏幕上的半径（像素）选择层次
+    // 变粗时阈值乘以 (1 - LOD_HYSTERESIS)，变细时使用原阈值，半径在两者之间时保持当前层次，避免来回跳变
+    static constexpr float LOD_HYSTERESIS = 0.15f;
+    // 每个分段在屏幕上允许的最大弧长（像素），由此得到每个层次适用的最大屏幕半径
+    static constexpr float LOD_PIXELS_PER_SEGMENT = 4.0f;
+    static float lodMaxScreenRadius(unsigned int segments) { return segments * LOD_PIXELS_PER_SEGMENT / (2.0f * glm::pi<float>()); }
 
-    Shader *shader;
+    void updateLod(float screenRadius)
+    {
+        int count = (int)lods.size();
+        while (lodLevel + 1 < count && screenRadius < lods[lodLevel + 1].maxScreenRadius * (1.0f - LOD_HYSTERESIS))
+            ++lodLevel;
+        while (lodLevel > 0 && screenRadius > lods[lodLevel].maxScreenRadius)
+            --lodLevel;
+    }
+    void resetLod() { lodLevel = 0; }
+    int getLodLevel() const { return lodLevel; }
+
+    // 提交给着色器的模型矩阵：物体变换 × 所用网格的位置反量化矩阵
+    glm::mat4 getMeshModel(int lodBias = 0) const { return model * getLodMesh(lodBias)->positionTransform; }
 
-    glm::mat4 model;
+    // 当前层次再加 bias 级对应的网格（没有 LOD 链时总是 mesh）
+    Mesh *getLodMesh(int bias = 0) const
+    {
+        if (lods.empty())
+            return mesh.get();
+        int level = std::min(lodLevel + bias, (int)lods.size() - 1);
+        return lods[level].mesh.get();
+    }
 
 protected:
-    unsigned int VAO, VBO, EBO;
     Material *material;
+
+    struct LodLevel
+    {
+        std::shared_ptr<Mesh> mesh;
+        float maxScreenRadius; // 屏幕半径不超过该值时可以使用这一层
+    };
+    // lods[0] 为最精细的层次（与 mesh 相同），越往后越粗糙
+    std::vector<LodLevel> lods;
+
+    // 设置着色器并缓存每次绘制都要用到的 uniform 句柄
+    void setShader(std::shared_ptr<Shader> _shader)
+    {
+        shader = _shader;
+        uModelHandle = shader->handle("uModel");
+        uViewHandle = shader->handle("uView");
+        uProjectionHandle = shader->handle("uProjection");
+    }
+
+private:
+    UniformHandle uModelHandle, uViewHandle, uProjectionHandle;
+
+    glm::mat4 model = glm::mat4(1.0f);
+    Bounds worldBounds;
+    unsigned int transformVersion = 0;
+    bool dynamic = false;
+    int lodLevel = 0;
 };
\ No newline at end of file
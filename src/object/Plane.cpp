@@ -1,39 +1,29 @@
 #include "Plane.h"
+#include "../ShaderLibrary.h"
 
 Plane::Plane(const char *vertexPath, const char *fragmentPath, Material *material)
 {
-    shader = new Shader(vertexPath, fragmentPath);
+    setShader(ShaderLibrary::get(vertexPath, fragmentPath));
     this->material = material;
 
-    // 创建 VAO、VBO 和 EBO
-    glGenVertexArrays(1, &VAO);
-    glGenBuffers(1, &VBO);
-    glGenBuffers(1, &EBO);
-
-    glBindVertexArray(VAO);
-
-    // 创建 VBO
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
-
-    // 创建 EBO
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
-
-    // 顶点属性：位置
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void *)0);
-    glEnableVertexAttribArray(0);
-
-    // 顶点属性：法线
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void *)(3 * sizeof(float)));
-    glEnableVertexAttribArray(1);
-
-    // 顶点属性：纹理坐标
-    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void *)(6 * sizeof(float)));
-    glEnableVertexAttribArray(2);
+    // 所有平面共享同一份几何数据
+    mesh = MeshCache::get("plane", generatePlaneData);
+}
 
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
+void Plane::generatePlaneData(std::vector<float> &vertices, std::vector<unsigned int> &indices)
+{
+    vertices = {
+        // 位置              // 法线             // 纹理坐标
+        -0.5f, -0.5f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, // 左下角
+        0.5f, -0.5f, 0.0f, 0.0f, 0.0f, 1.0f, 1.0f, 0.0f,  // 右下角
+        0.5f, 0.5f, 0.0f, 0.0f, 0.0f, 1.0f, 1.0f, 1.0f,   // 右上角
+        -0.5f, 0.5f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 1.0f   // 左上角
+    };
+
+    indices = {
+        0, 1, 2, // 第一个三角形
+        0, 2, 3  // 第二个三角形
+    };
 }
 
 void Plane::render(glm::mat4 model, glm::mat4 view, glm::mat4 projection)
@@ -42,18 +32,3 @@ void Plane::render(glm::mat4 model, glm::mat4 view, glm::mat4 projection)
 
     renderVertex();
 }
-
-Plane::~Plane()
-{
-    glDeleteVertexArrays(1, &VAO);
-    glDeleteBuffers(1, &VBO);
-    glDeleteBuffers(1, &EBO);
-    delete shader;
-}
-
-void Plane::renderVertex()
-{
-    glBindVertexArray(VAO);
-    glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0); // 使用索引绘制
-    glBindVertexArray(0);
-}
\ No newline at end of file
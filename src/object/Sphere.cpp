@@ -1,47 +1,33 @@
 #include "Sphere.h"
+#include "../ShaderLibrary.h"
+#include "../tool/CpuProfiler.h"
+#include <cfloat>
 
 Sphere::Sphere(const char *vertexPath, const char *fragmentPath, Material *material, float radius, unsigned int stacks, unsigned int slices)
     : radius(radius), stacks(stacks), slices(slices)
 {
-    shader = new Shader(vertexPath, fragmentPath);
+    setShader(ShaderLibrary::get(vertexPath, fragmentPath));
     this->material = material;
 
-    // 生成球体顶点和索引数据
-    generateSphereData();
-
-    // 创建 VAO、VBO 和 EBO
-    glGenVertexArrays(1, &VAO);
-    glGenBuffers(1, &VBO);
-    glGenBuffers(1, &EBO);
-
-    glBindVertexArray(VAO);
-
-    // 创建 VBO
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_STATIC_DRAW);
-
-    // 创建 EBO
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), indices.data(), GL_STATIC_DRAW);
-
-    // 顶点属性：位置
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void *)0);
-    glEnableVertexAttribArray(0);
-
-    // 顶点属性：法线
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void *)(3 * sizeof(float)));
-    glEnableVertexAttribArray(1);
-
-    // 顶点属性：纹理坐标
-    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void *)(6 * sizeof(float)));
-    glEnableVertexAttribArray(2);
-
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
+    // 相同半径和细分的球体共享同一份几何数据
+    // LOD 链：每级把堆叠和切片数减半，直到低于最小细分
+    unsigned int levelStacks = stacks, levelSlices = slices;
+    do
+    {
+        std::string key = "sphere r=" + std::to_string(radius) + " stacks=" + std::to_string(levelStacks) + " slices=" + std::to_string(levelSlices);
+        std::shared_ptr<Mesh> levelMesh = MeshCache::get(key, [=](std::vector<float> &vertices, std::vector<unsigned int> &indices)
+                                                         { generateSphereData(radius, levelStacks, levelSlices, vertices, indices); });
+        lods.push_back({levelMesh, lods.empty() ? FLT_MAX : lodMaxScreenRadius(levelSlices)});
+        levelStacks /= 2;
+        levelSlices /= 2;
+    } while (levelStacks >= MIN_LOD_STACKS && levelSlices >= MIN_LOD_SLICES);
+    mesh = lods[0].mesh;
 }
 
-void Sphere::generateSphereData()
+void Sphere::generateSphereData(float radius, unsigned int stacks, unsigned int slices,
+                                std::vector<float> &vertices, std::vector<unsigned int> &indices)
 {
+    CPU_PROFILE_FUNCTION();
     vertices.clear();
     indices.clear();
 
@@ -122,18 +108,3 @@ void Sphere::render(glm::mat4 uModel, glm::mat4 uView, glm::mat4 uProjection)
 
     renderVertex();
 }
-
-Sphere::~Sphere()
-{
-    glDeleteVertexArrays(1, &VAO);
-    glDeleteBuffers(1, &VBO);
-    glDeleteBuffers(1, &EBO);
-    delete shader;
-}
-
-void Sphere::renderVertex()
-{
-    glBindVertexArray(VAO);
-    glDrawElements(GL_TRIANGLES, indices.size(), GL_UNSIGNED_INT, 0); // 使用索引绘制球体
-    glBindVertexArray(0);
-}
\ No newline at end of file
@@ -11,18 +11,16 @@ public:
     // 渲染球体
     void render(glm::mat4 uModel, glm::mat4 uView, glm::mat4 uProjection);
 
-    // 析构函数
-    ~Sphere();
-
-    void renderVertex();
-
 private:
+    // LOD 链中最粗糙一级允许的最小细分
+    static constexpr unsigned int MIN_LOD_STACKS = 8;
+    static constexpr unsigned int MIN_LOD_SLICES = 16;
+
     float radius;
     unsigned int stacks; // 纬度（经度层次）
     unsigned int slices; // 经度（纬度层次）
 
-    std::vector<float> vertices;
-    std::vector<unsigned int> indices;
-
-    void generateSphereData();
+    // 生成球体顶点（位置、法线、纹理坐标）和索引数据
+    static void generateSphereData(float radius, unsigned int stacks, unsigned int slices,
+                                   std::vector<float> &vertices, std::vector<unsigned int> &indices);
 };
\ No newline at end of file
@@ -0,0 +1,163 @@
+#include "VertexLayout.h"
+
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/packing.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+namespace
+{
+    // 八面体编码：单位向量投影到 |x|+|y|+|z|=1 的八面体上，下半球沿对角线翻折到外侧，得到 [-1, 1]^2 的二维坐标
+    glm::vec2 octEncode(glm::vec3 n)
+    {
+        n /= std::fabs(n.x) + std::fabs(n.y) + std::fabs(n.z);
+        glm::vec2 p(n.x, n.y);
+        if (n.z < 0.0f)
+        {
+            glm::vec2 sign(p.x >= 0.0f ? 1.0f : -1.0f, p.y >= 0.0f ? 1.0f : -1.0f);
+            p = (glm::vec2(1.0f) - glm::abs(glm::vec2(p.y, p.x))) * sign;
+        }
+        return p;
+    }
+
+    void write16(std::vector<unsigned char> &out, size_t offset, uint16_t value)
+    {
+        std::memcpy(&out[offset], &value, sizeof(value));
+    }
+
+    VertexLayout makeLayout(VertexFormat format)
+    {
+        VertexLayout layout;
+        layout.format = format;
+        if (format == VERTEX_FORMAT_FLOAT)
+        {
+            layout.stride = 8 * sizeof(float);
+            layout.positionStride = 3 * sizeof(float);
+            layout.attributes = {
+                {0, 3, GL_FLOAT, GL_FALSE, 0},                 // 位置
+                {1, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float)}, // 法线
+                {2, 2, GL_FLOAT, GL_FALSE, 6 * sizeof(float)}  // 纹理坐标
+            };
+            return layout;
+        }
+
+        // 位置占 4 个分量（第 4 个为填充，保证 4 字节对齐），着色器只读前 3 个
+        layout.stride = 16;
+        layout.positionStride = 8;
+        layout.attributes = {
+            {0, 3, (GLenum)(format == VERTEX_FORMAT_HALF ? GL_HALF_FLOAT : GL_SHORT), (GLboolean)(format == VERTEX_FORMAT_SNORM16), 0},
+            {1, 2, GL_SHORT, GL_TRUE, 8},
+            {2, 2, GL_UNSIGNED_SHORT, GL_TRUE, 12}};
+        return layout;
+    }
+}
+
+const VertexLayout &VertexLayout::get(VertexFormat format)
+{
+    static const VertexLayout layouts[] = {
+        makeLayout(VERTEX_FORMAT_FLOAT),
+        makeLayout(VERTEX_FORMAT_HALF),
+        makeLayout(VERTEX_FORMAT_SNORM16)};
+    return layouts[format];
+}
+
+void VertexLayout::apply() const
+{
+    for (const VertexAttribute &attribute : attributes)
+    {
+        glVertexAttribPointer(attribute.location, attribute.size, attribute.type, attribute.normalized,
+                              stride, (void *)(size_t)attribute.offset);
+        glEnableVertexAttribArray(attribute.location);
+    }
+}
+
+void VertexLayout::applyPositions() const
+{
+    const VertexAttribute &position = attributes[0];
+    glVertexAttribPointer(position.location, position.size, position.type, position.normalized, positionStride, (void *)0);
+    glEnableVertexAttribArray(position.location);
+}
+
+std::vector<unsigned char> VertexLayout::extractPositions(const std::vector<unsigned char> &packed) const
+{
+    size_t count = packed.size() / stride;
+    std::vector<unsigned char> out(count * positionStride);
+    for (size_t i = 0; i < count; ++i)
+        std::memcpy(&out[i * positionStride], &packed[i * stride], positionStride);
+    return out;
+}
+
+std::vector<unsigned char> VertexLayout::pack(const std::vector<float> &vertices, glm::mat4 &positionTransform) const
+{
+    size_t count = vertices.size() / 8;
+    positionTransform = glm::mat4(1.0f);
+    if (format == VERTEX_FORMAT_FLOAT)
+    {
+        std::vector<unsigned char> out(vertices.size() * sizeof(float));
+        std::memcpy(out.data(), vertices.data(), out.size());
+        return out;
+    }
+
+    // 量化区间：包围盒中心 ± 最大半边长（均匀缩放）
+    glm::vec3 lo(0.0f), hi(0.0f);
+    for (size_t i = 0; i < count; ++i)
+    {
+        glm::vec3 p(vertices[i * 8], vertices[i * 8 + 1], vertices[i * 8 + 2]);
+        lo = i == 0 ? p : glm::min(lo, p);
+        hi = i == 0 ? p : glm::max(hi, p);
+    }
+    glm::vec3 center = (lo + hi) * 0.5f;
+    glm::vec3 halfExtent = (hi - lo) * 0.5f;
+    float scale = std::max(std::max(halfExtent.x, halfExtent.y), halfExtent.z);
+    if (scale <= 0.0f)
+        scale = 1.0f;
+    positionTransform = glm::scale(glm::translate(glm::mat4(1.0f), center), glm::vec3(scale));
+
+    std::vector<unsigned char> out(count * stride);
+    for (size_t i = 0; i < count; ++i)
+    {
+        const float *v = &vertices[i * 8];
+        size_t base = i * stride;
+
+        glm::vec3 p = (glm::vec3(v[0], v[1], v[2]) - center) / scale;
+        for (int c = 0; c < 3; ++c)
+            write16(out, base + c * 2, format == VERTEX_FORMAT_HALF ? glm::packHalf1x16(p[c]) : glm::packSnorm1x16(p[c]));
+        write16(out, base + 6, format == VERTEX_FORMAT_HALF ? glm::packHalf1x16(1.0f) : glm::packSnorm1x16(1.0f));
+
+        glm::vec2 n = octEncode(glm::vec3(v[3], v[4], v[5]));
+        write16(out, base + 8, glm::packSnorm1x16(n.x));
+        write16(out, base + 10, glm::packSnorm1x16(n.y));
+
+        write16(out, base + 12, glm::packUnorm1x16(v[6]));
+        write16(out, base + 14, glm::packUnorm1x16(v[7]));
+    }
+    return out;
+}
+
+const char *VertexLayout::name(VertexFormat format)
+{
+    switch (format)
+    {
+    case VERTEX_FORMAT_HALF:
+        return "half";
+    case VERTEX_FORMAT_SNORM16:
+        return "snorm16";
+    default:
+        return "float";
+    }
+}
+
+bool VertexLayout::parse(const std::string &name, VertexFormat &format)
+{
+    for (VertexFormat candidate : {VERTEX_FORMAT_FLOAT, VERTEX_FORMAT_HALF, VERTEX_FORMAT_SNORM16})
+    {
+        if (name == VertexLayout::name(candidate))
+        {
+            format = candidate;
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <string>
+#include <vector>
+
+// 顶点在 GPU 上的存储格式；生成几何时统一使用 8 个 float 的交错格式，上传时再打包
+enum VertexFormat
+{
+    VERTEX_FORMAT_FLOAT,  // 位置 3 float + 法线 3 float + 纹理坐标 2 float，共 32 字节
+    VERTEX_FORMAT_HALF,   // 位置 4 half + 八面体法线 2 snorm16 + 纹理坐标 2 unorm16，共 16 字节
+    VERTEX_FORMAT_SNORM16 // 位置 4 snorm16 + 八面体法线 2 snorm16 + 纹理坐标 2 unorm16，共 16 字节
+};
+
+// 一个顶点属性在交错缓冲中的描述
+struct VertexAttribute
+{
+    unsigned int location;
+    int size;
+    GLenum type;
+    GLboolean normalized;
+    unsigned int offset;
+};
+
+// 顶点布局：步长 + 各属性的类型和偏移，由 Mesh 在创建 VAO 时应用
+// 压缩格式说明：
+//  - 位置先变换到网格包围盒中心、以最大半边长为单位的 [-1, 1] 区间再量化，
+//    反量化矩阵（平移 + 均匀缩放）由调用方乘进模型矩阵，均匀缩放不影响法线方向
+//  - 法线使用八面体编码（2 个分量），着色器需要定义 OCTAHEDRAL_NORMAL 来解码
+//  - 纹理坐标按 [0, 1] 量化为 unorm16，超出范围的值会被截断
+struct VertexLayout
+{
+    VertexFormat format;
+    unsigned int stride;
+    std::vector<VertexAttribute> attributes;
+    unsigned int positionStride; // 只含位置的紧凑流的步长（深度 pass 使用）
+
+    static const VertexLayout &get(VertexFormat format);
+
+    // 压缩格式的法线需要着色器解码
+    bool octahedralNormal() const { return format != VERTEX_FORMAT_FLOAT; }
+
+    // 为当前绑定的 VAO / VBO 设置并启用顶点属性
+    void apply() const;
+    // 只含位置的流：location 0，步长 positionStride
+    void applyPositions() const;
+
+    // 把 8 float 交错顶点打包成该格式；positionTransform 返回反量化矩阵（浮点格式为单位矩阵）
+    std::vector<unsigned char> pack(const std::vector<float> &vertices, glm::mat4 &positionTransform) const;
+    // 从打包好的交错顶点中取出每个顶点开头的位置，得到紧凑的位置流
+    std::vector<unsigned char> extractPositions(const std::vector<unsigned char> &packed) const;
+
+    static const char *name(VertexFormat format);
+    static bool parse(const std::string &name, VertexFormat &format);
+};
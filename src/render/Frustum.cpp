@@ -0,0 +1,163 @@
+#include "Frustum.h"
+
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define FRUSTUM_USE_SSE
+#endif
+
+void BoundsArray::clear()
+{
+    sphereX.clear();
+    sphereY.clear();
+    sphereZ.clear();
+    sphereRadius.clear();
+    boxX.clear();
+    boxY.clear();
+    boxZ.clear();
+    extentX.clear();
+    extentY.clear();
+    extentZ.clear();
+}
+
+void BoundsArray::add(const Bounds &bounds)
+{
+    glm::vec3 center = (bounds.aabbMin + bounds.aabbMax) * 0.5f;
+    glm::vec3 extent = (bounds.aabbMax - bounds.aabbMin) * 0.5f;
+    sphereX.push_back(bounds.sphereCenter.x);
+    sphereY.push_back(bounds.sphereCenter.y);
+    sphereZ.push_back(bounds.sphereCenter.z);
+    sphereRadius.push_back(bounds.sphereRadius);
+    boxX.push_back(center.x);
+    boxY.push_back(center.y);
+    boxZ.push_back(center.z);
+    extentX.push_back(extent.x);
+    extentY.push_back(extent.y);
+    extentZ.push_back(extent.z);
+}
+
+void Frustum::extract(const glm::mat4 &m)
+{
+    // glm 是列主序，m[c][r]；第 r 行为 (m[0][r], m[1][r], m[2][r], m[3][r])
+    glm::vec4 row0(m[0][0], m[1][0], m[2][0], m[3][0]);
+    glm::vec4 row1(m[0][1], m[1][1], m[2][1], m[3][1]);
+    glm::vec4 row2(m[0][2], m[1][2], m[2][2], m[3][2]);
+    glm::vec4 row3(m[0][3], m[1][3], m[2][3], m[3][3]);
+
+    planes[0] = row3 + row0; // 左
+    planes[1] = row3 - row0; // 右
+    planes[2] = row3 + row1; // 下
+    planes[3] = row3 - row1; // 上
+    planes[4] = row3 + row2; // 近（OpenGL 裁剪空间 z ∈ [-w, w]）
+    planes[5] = row3 - row2; // 远
+
+    for (glm::vec4 &plane : planes)
+        plane /= glm::length(glm::vec3(plane));
+}
+
+bool Frustum::isVisible(const Bounds &bounds) const
+{
+    glm::vec3 center = (bounds.aabbMin + bounds.aabbMax) * 0.5f;
+    glm::vec3 extent = (bounds.aabbMax - bounds.aabbMin) * 0.5f;
+    for (const glm::vec4 &plane : planes)
+    {
+        glm::vec3 n(plane);
+        if (glm::dot(n, bounds.sphereCenter) + plane.w < -bounds.sphereRadius)
+            return false;
+        if (glm::dot(n, center) + plane.w < -glm::dot(glm::abs(n), extent))
+            return false;
+    }
+    return true;
+}
+
+unsigned int Frustum::cull(const BoundsArray &bounds, std::vector<unsigned char> &visible) const
+{
+    size_t count = bounds.size();
+    visible.resize(count);
+    unsigned int visibleCount = 0;
+    size_t i = 0;
+
+#ifdef FRUSTUM_USE_SSE
+    __m128 nx[6], ny[6], nz[6], nd[6], ax[6], ay[6], az[6];
+    const __m128 signMask = _mm_set1_ps(-0.0f);
+    for (int p = 0; p < 6; ++p)
+    {
+        nx[p] = _mm_set1_ps(planes[p].x);
+        ny[p] = _mm_set1_ps(planes[p].y);
+        nz[p] = _mm_set1_ps(planes[p].z);
+        nd[p] = _mm_set1_ps(planes[p].w);
+        ax[p] = _mm_andnot_ps(signMask, nx[p]);
+        ay[p] = _mm_andnot_ps(signMask, ny[p]);
+        az[p] = _mm_andnot_ps(signMask, nz[p]);
+    }
+
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128 sx = _mm_loadu_ps(&bounds.sphereX[i]);
+        __m128 sy = _mm_loadu_ps(&bounds.sphereY[i]);
+        __m128 sz = _mm_loadu_ps(&bounds.sphereZ[i]);
+        __m128 negRadius = _mm_xor_ps(_mm_loadu_ps(&bounds.sphereRadius[i]), signMask);
+        __m128 cx = _mm_loadu_ps(&bounds.boxX[i]);
+        __m128 cy = _mm_loadu_ps(&bounds.boxY[i]);
+        __m128 cz = _mm_loadu_ps(&bounds.boxZ[i]);
+        __m128 ex = _mm_loadu_ps(&bounds.extentX[i]);
+        __m128 ey = _mm_loadu_ps(&bounds.extentY[i]);
+        __m128 ez = _mm_loadu_ps(&bounds.extentZ[i]);
+
+        // 任何一个平面把包围球或 AABB 完全排除在外，对应通道就被剔除
+        __m128 outside = _mm_setzero_ps();
+        for (int p = 0; p < 6; ++p)
+        {
+            __m128 sphereDist = _mm_add_ps(_mm_add_ps(_mm_mul_ps(nx[p], sx), _mm_mul_ps(ny[p], sy)),
+                                           _mm_add_ps(_mm_mul_ps(nz[p], sz), nd[p]));
+            __m128 boxDist = _mm_add_ps(_mm_add_ps(_mm_mul_ps(nx[p], cx), _mm_mul_ps(ny[p], cy)),
+                                        _mm_add_ps(_mm_mul_ps(nz[p], cz), nd[p]));
+            __m128 boxRadius = _mm_add_ps(_mm_add_ps(_mm_mul_ps(ax[p], ex), _mm_mul_ps(ay[p], ey)), _mm_mul_ps(az[p], ez));
+            outside = _mm_or_ps(outside, _mm_cmplt_ps(sphereDist, negRadius));
+            outside = _mm_or_ps(outside, _mm_cmplt_ps(boxDist, _mm_xor_ps(boxRadius, signMask)));
+        }
+
+        int mask = _mm_movemask_ps(outside);
+        for (int lane = 0; lane < 4; ++lane)
+        {
+            unsigned char inside = (mask >> lane) & 1 ? 0 : 1;
+            visible[i + lane] = inside;
+            visibleCount += inside;
+        }
+    }
+#endif
+
+    // 剩余不足 4 个（或没有 SSE）时逐个测试
+    for (; i < count; ++i)
+    {
+        Bounds single;
+        glm::vec3 center(bounds.boxX[i], bounds.boxY[i], bounds.boxZ[i]);
+        glm::vec3 extent(bounds.extentX[i], bounds.extentY[i], bounds.extentZ[i]);
+        single.aabbMin = center - extent;
+        single.aabbMax = center + extent;
+        single.sphereCenter = glm::vec3(bounds.sphereX[i], bounds.sphereY[i], bounds.sphereZ[i]);
+        single.sphereRadius = bounds.sphereRadius[i];
+        visible[i] = isVisible(single) ? 1 : 0;
+        visibleCount += visible[i];
+    }
+    return visibleCount;
+}
+
+unsigned int Frustum::intersectSphere(const BoundsArray &bounds, const glm::vec3 &center, float radius,
+                                      std::vector<unsigned char> &inside)
+{
+    size_t count = bounds.size();
+    inside.resize(count);
+    unsigned int insideCount = 0;
+    for (size_t i = 0; i < count; ++i)
+    {
+        float dx = bounds.sphereX[i] - center.x;
+        float dy = bounds.sphereY[i] - center.y;
+        float dz = bounds.sphereZ[i] - center.z;
+        float reach = radius + bounds.sphereRadius[i];
+        inside[i] = dx * dx + dy * dy + dz * dz <= reach * reach ? 1 : 0;
+        insideCount += inside[i];
+    }
+    return insideCount;
+}
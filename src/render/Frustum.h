@@ -0,0 +1,37 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <vector>
+
+#include "../object/Bounds.h"
+
+// 批量剔除用的包围体数组（SoA 布局，SIMD 一次读取 4 个物体的同一个分量）
+struct BoundsArray
+{
+    std::vector<float> sphereX, sphereY, sphereZ, sphereRadius;
+    std::vector<float> boxX, boxY, boxZ, extentX, extentY, extentZ; // AABB 中心和半长
+
+    size_t size() const { return sphereRadius.size(); }
+    void clear();
+    void add(const Bounds &bounds);
+};
+
+// 视锥体：6 个平面 (n, d)，法线指向内部，点 p 在内侧当且仅当 dot(n, p) + d >= 0
+class Frustum
+{
+public:
+    glm::vec4 planes[6];
+
+    // 从 projection * view 矩阵提取平面（Gribb & Hartmann）
+    void extract(const glm::mat4 &viewProjection);
+
+    // 包围球和 AABB 都与视锥体相交才算可见，visible[i] 为 1 表示第 i 个可见，返回可见数量
+    // x86 上用 SSE 每次测试 4 个物体，其他平台退化为逐个测试
+    unsigned int cull(const BoundsArray &bounds, std::vector<unsigned char> &visible) const;
+
+    bool isVisible(const Bounds &bounds) const;
+
+    // 包围球与球 (center, radius) 相交时 inside[i] 为 1（例如点光源的照射范围），返回相交数量
+    static unsigned int intersectSphere(const BoundsArray &bounds, const glm::vec3 &center, float radius,
+                                        std::vector<unsigned char> &inside);
+};
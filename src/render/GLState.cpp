@@ -0,0 +1,196 @@
+#include "GLState.h"
+#include "../tool/FrameStats.h"
+
+#include <cstdio>
+
+unsigned int GLState::program = GLState::UNKNOWN;
+unsigned int GLState::vertexArray = GLState::UNKNOWN;
+unsigned int GLState::activeUnit = GLState::UNKNOWN;
+unsigned int GLState::textures[GLState::MAX_TEXTURE_UNITS][GLState::TEXTURE_TARGET_COUNT];
+unsigned int GLState::readFramebuffer = GLState::UNKNOWN;
+unsigned int GLState::drawFramebuffer = GLState::UNKNOWN;
+int GLState::viewportRect[4] = {0, 0, 0, 0};
+bool GLState::viewportKnown = false;
+GLState::Counter GLState::counters[GLState::CATEGORY_COUNT];
+
+void GLState::count(Category category, bool issued)
+{
+    if (issued)
+        ++counters[category].issued;
+    else
+        ++counters[category].elided;
+    FrameStats::addGLCall(issued);
+}
+
+void GLState::useProgram(unsigned int id)
+{
+    bool issued = program != id;
+    if (issued)
+    {
+        glUseProgram(id);
+        program = id;
+    }
+    count(PROGRAM, issued);
+}
+
+void GLState::bindVertexArray(unsigned int vao)
+{
+    bool issued = vertexArray != vao;
+    if (issued)
+    {
+        glBindVertexArray(vao);
+        vertexArray = vao;
+    }
+    count(VERTEX_ARRAY, issued);
+}
+
+int GLState::targetIndex(GLenum target)
+{
+    switch (target)
+    {
+    case GL_TEXTURE_2D:
+        return 0;
+    case GL_TEXTURE_CUBE_MAP:
+        return 1;
+    case GL_TEXTURE_2D_ARRAY:
+        return 2;
+    default:
+        return -1;
+    }
+}
+
+void GLState::activeTexture(unsigned int unit)
+{
+    bool issued = activeUnit != unit;
+    if (issued)
+    {
+        glActiveTexture(GL_TEXTURE0 + unit);
+        activeUnit = unit;
+    }
+    count(ACTIVE_TEXTURE, issued);
+}
+
+void GLState::bindTexture(unsigned int unit, GLenum target, unsigned int texture)
+{
+    int index = targetIndex(target);
+    bool cached = unit < MAX_TEXTURE_UNITS && index >= 0;
+    if (cached && textures[unit][index] == texture)
+    {
+        count(TEXTURE, false);
+        return;
+    }
+
+    activeTexture(unit);
+    glBindTexture(target, texture);
+    if (cached)
+        textures[unit][index] = texture;
+    count(TEXTURE, true);
+}
+
+void GLState::bindFramebuffer(GLenum target, unsigned int fbo)
+{
+    bool read = target == GL_FRAMEBUFFER || target == GL_READ_FRAMEBUFFER;
+    bool draw = target == GL_FRAMEBUFFER || target == GL_DRAW_FRAMEBUFFER;
+    bool issued = (read && readFramebuffer != fbo) || (draw && drawFramebuffer != fbo);
+    if (issued)
+    {
+        glBindFramebuffer(target, fbo);
+        if (read)
+            readFramebuffer = fbo;
+        if (draw)
+            drawFramebuffer = fbo;
+    }
+    count(FRAMEBUFFER, issued);
+}
+
+void GLState::viewport(int x, int y, int width, int height)
+{
+    bool issued = !viewportKnown || viewportRect[0] != x || viewportRect[1] != y ||
+                  viewportRect[2] != width || viewportRect[3] != height;
+    if (issued)
+    {
+        glViewport(x, y, width, height);
+        viewportRect[0] = x;
+        viewportRect[1] = y;
+        viewportRect[2] = width;
+        viewportRect[3] = height;
+        viewportKnown = true;
+    }
+    count(VIEWPORT, issued);
+}
+
+// 删除当前绑定的对象时 GL 会把绑定恢复为 0
+// （当前使用中的程序删除后仍然有效，直到切换为其他程序；之后 id 可能被重新分配，同样视为未绑定）
+void GLState::forgetProgram(unsigned int _program)
+{
+    if (program == _program)
+        program = UNKNOWN;
+}
+
+void GLState::forgetVertexArray(unsigned int vao)
+{
+    if (vertexArray == vao)
+        vertexArray = 0;
+}
+
+void GLState::forgetTexture(unsigned int texture)
+{
+    for (auto &unit : textures)
+    {
+        for (unsigned int &bound : unit)
+        {
+            if (bound == texture)
+                bound = 0;
+        }
+    }
+}
+
+void GLState::forgetFramebuffer(unsigned int fbo)
+{
+    if (readFramebuffer == fbo)
+        readFramebuffer = 0;
+    if (drawFramebuffer == fbo)
+        drawFramebuffer = 0;
+}
+
+void GLState::invalidate()
+{
+    program = UNKNOWN;
+    vertexArray = UNKNOWN;
+    activeUnit = UNKNOWN;
+    for (auto &unit : textures)
+    {
+        for (unsigned int &bound : unit)
+            bound = UNKNOWN;
+    }
+    readFramebuffer = UNKNOWN;
+    drawFramebuffer = UNKNOWN;
+    viewportKnown = false;
+}
+
+const char *GLState::name(Category category)
+{
+    switch (category)
+    {
+    case PROGRAM:
+        return "program";
+    case VERTEX_ARRAY:
+        return "vertex array";
+    case ACTIVE_TEXTURE:
+        return "active texture";
+    case TEXTURE:
+        return "texture";
+    case FRAMEBUFFER:
+        return "framebuffer";
+    default:
+        return "viewport";
+    }
+}
+
+void GLState::printCounters()
+{
+    std::printf("gl state calls (issued / elided):");
+    for (int i = 0; i < CATEGORY_COUNT; ++i)
+        std::printf("  %s %llu / %llu", name((Category)i), counters[i].issued, counters[i].elided);
+    std::printf("\n");
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <glad/glad.h>
+
+// OpenGL 状态缓存：记录当前的着色器程序、VAO、各纹理单元绑定的贴图、帧缓冲和视口，
+// 与当前值相同的调用直接跳过。程序中所有这类绑定都应通过这里进行；
+// 如果有代码绕过它直接调用 GL（或者上下文被外部修改），需要调用 invalidate()
+// 删除对象时调用对应的 forget*()，避免 id 被重新分配后被误认为仍然绑定着
+class GLState
+{
+public:
+    enum Category
+    {
+        PROGRAM,
+        VERTEX_ARRAY,
+        ACTIVE_TEXTURE,
+        TEXTURE,
+        FRAMEBUFFER,
+        VIEWPORT,
+        CATEGORY_COUNT
+    };
+
+    // 实际发出 / 被跳过的调用次数（从程序开始累计）
+    struct Counter
+    {
+        unsigned long long issued = 0;
+        unsigned long long elided = 0;
+    };
+
+    // 缓存覆盖的纹理单元数和纹理目标（2D、立方体贴图、2D 数组），超出范围的绑定照常发出
+    static const unsigned int MAX_TEXTURE_UNITS = 16;
+
+    static void useProgram(unsigned int program);
+    static void bindVertexArray(unsigned int vao);
+    static void bindTexture(unsigned int unit, GLenum target, unsigned int texture);
+    // target 为 GL_FRAMEBUFFER 时同时设置读和写帧缓冲
+    static void bindFramebuffer(GLenum target, unsigned int fbo);
+    static void viewport(int x, int y, int width, int height);
+
+    static void forgetProgram(unsigned int program);
+    static void forgetVertexArray(unsigned int vao);
+    static void forgetTexture(unsigned int texture);
+    static void forgetFramebuffer(unsigned int fbo);
+
+    // 所有状态置为未知，之后每类状态的第一次调用一定会发出（创建上下文后先调用一次）
+    static void invalidate();
+
+    static const Counter &counter(Category category) { return counters[category]; }
+    static const char *name(Category category);
+    // 输出各类调用的累计次数
+    static void printCounters();
+
+private:
+    static const unsigned int TEXTURE_TARGET_COUNT = 3;
+    static const unsigned int UNKNOWN = ~0u;
+
+    static unsigned int program;
+    static unsigned int vertexArray;
+    static unsigned int activeUnit;
+    static unsigned int textures[MAX_TEXTURE_UNITS][TEXTURE_TARGET_COUNT];
+    static unsigned int readFramebuffer;
+    static unsigned int drawFramebuffer;
+    static int viewportRect[4];
+    static bool viewportKnown;
+    static Counter counters[CATEGORY_COUNT];
+
+    // 记录一次调用：issued 为 false 表示被跳过
+    static void count(Category category, bool issued);
+    static int targetIndex(GLenum target);
+    static void activeTexture(unsigned int unit);
+};
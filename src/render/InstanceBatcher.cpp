@@ -0,0 +1,260 @@
+#include "InstanceBatcher.h"
+#include "../ShaderLibrary.h"
+#include "../object/Object.h"
+#include "../texture/Texture.h"
+#include "UniformBuffers.h"
+#include "GLState.h"
+#include "../tool/FrameStats.h"
+
+#include <algorithm>
+
+namespace
+{
+    typedef void(APIENTRYP MultiDrawElementsIndirectProc)(GLenum mode, GLenum type, const void *indirect,
+                                                          GLsizei drawcount, GLsizei stride);
+    MultiDrawElementsIndirectProc multiDrawElementsIndirect = nullptr;
+}
+
+InstanceBatcher::InstanceBatcher()
+    : instanceVBO(0), capacity(0), depthStreams(true), multiDraw(false), indirectBuffer(0), indirectCapacity(0),
+      viewPosition(0.0f)
+{
+}
+
+InstanceBatcher::~InstanceBatcher()
+{
+    if (instanceVBO != 0)
+        glDeleteBuffers(1, &instanceVBO);
+    if (indirectBuffer != 0)
+        glDeleteBuffers(1, &indirectBuffer);
+}
+
+bool InstanceBatcher::enableMultiDraw(GLADloadproc loadProc)
+{
+    multiDrawElementsIndirect = (MultiDrawElementsIndirectProc)loadProc("glMultiDrawElementsIndirect");
+    if (multiDrawElementsIndirect == nullptr)
+        return false;
+    if (indirectBuffer == 0)
+        glGenBuffers(1, &indirectBuffer);
+    multiDraw = true;
+    return true;
+}
+
+void InstanceBatcher::init()
+{
+    glGenBuffers(1, &instanceVBO);
+}
+
+Shader *InstanceBatcher::instancedVariant(const std::shared_ptr<Shader> &shader)
+{
+    InstancedShader &entry = instancedShaders[shader.get()];
+    if (!entry.variant || entry.base.expired())
+    {
+        entry.base = shader;
+        entry.variant = ShaderLibrary::variant(*shader, "USE_INSTANCING");
+    }
+    return entry.variant.get();
+}
+
+void InstanceBatcher::begin()
+{
+    instances.clear();
+    commands.clear();
+    passes.clear();
+
+    // 普通着色器已经释放的项一并释放实例化变体
+    for (auto it = instancedShaders.begin(); it != instancedShaders.end();)
+    {
+        if (it->second.base.expired())
+            it = instancedShaders.erase(it);
+        else
+            ++it;
+    }
+}
+
+int InstanceBatcher::addPass(const std::vector<Object *> &objects, bool depthOnly, int lodBias, const std::vector<int> &faceMasks)
+{
+    struct Entry
+    {
+        const Object *object;
+        const Mesh *mesh;
+        Shader *shader;
+        const Texture *texture;
+        int faceMask;
+    };
+    std::vector<Entry> entries;
+    entries.reserve(objects.size());
+    for (size_t i = 0; i < objects.size(); ++i)
+    {
+        const Object *obj = objects[i];
+        int faceMask = faceMasks.empty() ? 0x3f : faceMasks[i];
+        const Mesh *mesh = obj->getLodMesh(lodBias);
+        if (depthOnly)
+            entries.push_back({obj, mesh, nullptr, nullptr, faceMask});
+        else
+            entries.push_back({obj, mesh, instancedVariant(obj->shader), obj->getMaterial()->getDiffuseMap(), faceMask});
+    }
+
+    // 材质通过实例属性传入，不影响分批，排序键中材质字段为 0
+    queue.clear();
+    for (const Entry &entry : entries)
+    {
+        queue.add((unsigned int)passes.size(), entry.shader ? entry.shader->ID : 0, entry.texture ? entry.texture->id : 0,
+                  0, entry.mesh->id, RenderQueue::viewDistance(entry.object->getWorldBounds(), viewPosition));
+    }
+    queue.sort();
+
+    Pass pass;
+    pass.depthOnly = depthOnly;
+    for (const RenderQueue::Item &item : queue.items())
+    {
+        const Entry &entry = entries[item.index];
+        const Mesh *mesh = entry.mesh;
+        unsigned int index = (unsigned int)instances.size();
+
+        InstanceData data;
+        data.model = entry.object->getModel() * mesh->positionTransform;
+        data.materialIndex = std::max(entry.object->getMaterial()->materialIndex, 0);
+        data.faceMask = entry.faceMask;
+        instances.push_back(data);
+
+        std::vector<Batch> &batches = pass.batches;
+        if (batches.empty() || batches.back().mesh != mesh ||
+            batches.back().shader != entry.shader || batches.back().texture != entry.texture)
+            batches.push_back({mesh, entry.shader, entry.texture, index, 0});
+        ++batches.back().instanceCount;
+    }
+
+    if (multiDraw)
+        buildRuns(pass);
+    passes.push_back(pass);
+    return (int)passes.size() - 1;
+}
+
+void InstanceBatcher::upload()
+{
+    size_t bytes = instances.size() * sizeof(InstanceData);
+    glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+    if (bytes > capacity)
+    {
+        capacity = bytes;
+        glBufferData(GL_ARRAY_BUFFER, capacity, instances.data(), GL_DYNAMIC_DRAW);
+    }
+    else if (bytes > 0)
+    {
+        glBufferSubData(GL_ARRAY_BUFFER, 0, bytes, instances.data());
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    if (!multiDraw)
+        return;
+    bytes = commands.size() * sizeof(DrawCommand);
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, indirectBuffer);
+    if (bytes > indirectCapacity)
+    {
+        indirectCapacity = bytes;
+        glBufferData(GL_DRAW_INDIRECT_BUFFER, indirectCapacity, commands.data(), GL_DYNAMIC_DRAW);
+    }
+    else if (bytes > 0)
+    {
+        glBufferSubData(GL_DRAW_INDIRECT_BUFFER, 0, bytes, commands.data());
+    }
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+}
+
+void InstanceBatcher::buildRuns(Pass &pass)
+{
+    bool depthOnly = pass.depthOnly && depthStreams;
+    for (const Batch &batch : pass.batches)
+    {
+        const Mesh *mesh = batch.mesh;
+        unsigned int vertexArray = mesh->getVertexArray(depthOnly);
+        std::vector<Run> &runs = pass.runs;
+        if (runs.empty() || runs.back().shader != batch.shader || runs.back().texture != batch.texture ||
+            runs.back().vertexArray != vertexArray || runs.back().indexType != mesh->indexType)
+            runs.push_back({batch.shader, batch.texture, vertexArray, mesh->indexType, (unsigned int)commands.size(), 0, 0, 0});
+
+        Run &run = runs.back();
+        commands.push_back({mesh->indexCount, batch.instanceCount, mesh->firstIndex, (int)mesh->baseVertex, batch.firstInstance});
+        ++run.commandCount;
+        run.triangles += (unsigned long long)mesh->indexCount / 3 * batch.instanceCount;
+        run.fetchBytes += mesh->fetchBytes(depthOnly) * batch.instanceCount;
+    }
+}
+
+void InstanceBatcher::drawRuns(const Pass &pass) const
+{
+    Shader *currentShader = nullptr;
+    const Texture *currentTexture = nullptr;
+    unsigned int currentVertexArray = 0;
+    RenderQueue::StateChanges changes;
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, indirectBuffer);
+    for (const Run &run : pass.runs)
+    {
+        if (run.shader != nullptr && run.shader != currentShader)
+        {
+            run.shader->use();
+            currentShader = run.shader;
+            ++changes.programs;
+        }
+        if (run.texture != nullptr && run.texture != currentTexture)
+        {
+            run.texture->bind(DIFFUSE_TEXTURE_UNIT);
+            currentTexture = run.texture;
+            ++changes.textures;
+        }
+        // 同一个 VAO 内切换网格只是改变命令里的偏移，不再算作状态切换
+        if (run.vertexArray != currentVertexArray)
+        {
+            currentVertexArray = run.vertexArray;
+            ++changes.meshes;
+        }
+
+        // 实例属性从实例缓冲开头读取，每条命令的 baseInstance 定位到自己的实例
+        GLState::bindVertexArray(run.vertexArray);
+        Mesh::bindInstanceAttributes(instanceVBO, 0, 1);
+        multiDrawElementsIndirect(GL_TRIANGLES, run.indexType, (const void *)(run.firstCommand * sizeof(DrawCommand)),
+                                  (GLsizei)run.commandCount, 0);
+        FrameStats::addDrawCall(run.triangles, run.fetchBytes);
+    }
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+    FrameStats::addStateChanges(changes.programs, changes.textures, changes.materials, changes.meshes);
+}
+
+void InstanceBatcher::draw(int pass, unsigned int repeat) const
+{
+    // 逐面分层渲染（repeat > 1）需要把实例属性除数设为 repeat，仍按批绘制
+    if (multiDraw && repeat == 1)
+    {
+        drawRuns(passes[pass]);
+        return;
+    }
+
+    Shader *currentShader = nullptr;
+    const Texture *currentTexture = nullptr;
+    const Mesh *currentMesh = nullptr;
+    RenderQueue::StateChanges changes;
+    bool depthOnly = passes[pass].depthOnly && depthStreams;
+    for (const Batch &batch : passes[pass].batches)
+    {
+        if (batch.shader != nullptr && batch.shader != currentShader)
+        {
+            batch.shader->use();
+            currentShader = batch.shader;
+            ++changes.programs;
+        }
+        if (batch.texture != nullptr && batch.texture != currentTexture)
+        {
+            batch.texture->bind(DIFFUSE_TEXTURE_UNIT);
+            currentTexture = batch.texture;
+            ++changes.textures;
+        }
+        if (batch.mesh != currentMesh)
+        {
+            currentMesh = batch.mesh;
+            ++changes.meshes;
+        }
+        batch.mesh->drawInstanced(instanceVBO, batch.firstInstance, batch.instanceCount, repeat, depthOnly);
+    }
+    FrameStats::addStateChanges(changes.programs, changes.textures, changes.materials, changes.meshes);
+}
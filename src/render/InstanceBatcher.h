@@ -0,0 +1,131 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <map>
+#include <memory>
+#include <vector>
+
+#include "../Shader.h"
+#include "../object/Mesh.h"
+#include "RenderQueue.h"
+
+class Object;
+class Texture;
+
+// 把共享同一个 Mesh 的物体合并成实例化绘制
+// 每帧为每个 pass 提交一份物体列表（例如相机剔除后的可见物体、阴影投射物体），
+// 所有 pass 的模型矩阵和材质下标写入同一个实例缓冲，一次上传：
+// 每个 pass 的物体经 RenderQueue 排序（默认按 着色器 → 漫反射贴图 → mesh → 由近到远），
+// 连续的相同 (mesh, 着色器, 贴图) 合成一批，每批一次绘制；深度 pass 只按 mesh 分批
+// 物体的着色器需要支持 USE_INSTANCING 宏（从实例属性读取模型矩阵和材质下标）
+// 开启多重间接绘制（GL 4.3 / ARB_multi_draw_indirect）时，连续的相同 (着色器, 贴图, VAO) 的批次
+// 写成一组间接绘制命令，一次 glMultiDrawElementsIndirect 提交；命令的 baseInstance 指向实例缓冲中该批的第一个实例，
+// 实例属性从缓冲开头读取即可，着色器不需要改动（网格在 MeshArena 中共用 VAO 时才能合并）
+class InstanceBatcher
+{
+public:
+    InstanceBatcher();
+    ~InstanceBatcher();
+
+    void init();
+
+    // 排序策略和相机位置（由近到远排序使用，每帧在 addPass 之前设置）
+    void setSortPolicy(SortPolicy policy) { queue.setPolicy(policy); }
+    void setView(const glm::vec3 &eye, float maxDistance)
+    {
+        viewPosition = eye;
+        queue.setMaxDistance(maxDistance);
+    }
+
+    // 开始新的一帧，清空上一帧的所有 pass
+    void begin();
+
+    // 添加一个 pass，返回编号；depthOnly 的 pass 只按 mesh 分批，由调用方绑定着色器
+    // lodBias 在物体当前细节层次上再粗糙几级（阴影 pass 使用），按最终使用的 LOD 网格分批
+    // faceMasks 非空时与 objects 一一对应，写入实例的立方体贴图面掩码（分层阴影渲染使用）
+    int addPass(const std::vector<Object *> &objects, bool depthOnly, int lodBias = 0, const std::vector<int> &faceMasks = {});
+
+    // 上传本帧所有 pass 的实例数据，在第一次 draw 之前调用
+    void upload();
+
+    // 主 pass 按批切换实例化着色器和贴图；深度 pass 使用调用方已绑定的着色器，并且只读取网格的位置流
+    // repeat 见 Mesh::drawInstanced
+    void draw(int pass, unsigned int repeat = 1) const;
+
+    // 深度 pass 是否使用只含位置的深度 VAO（关闭时与主 pass 一样绑定完整的交错顶点，用于对比带宽）
+    void setDepthStreams(bool enabled) { depthStreams = enabled; }
+
+    // 加载 glMultiDrawElementsIndirect 并开启多重间接绘制（GL 4.1 的头文件里没有这个函数，需要上下文支持 4.3 或对应扩展），
+    // 加载失败时返回 false，保持逐批绘制；需在 init() 之后、第一次 addPass 之前调用
+    bool enableMultiDraw(GLADloadproc loadProc);
+    bool multiDrawEnabled() const { return multiDraw; }
+
+    unsigned int instanceCount() const { return (unsigned int)instances.size(); }
+    unsigned int batchCount(int pass) const { return (unsigned int)passes[pass].batches.size(); }
+
+private:
+    struct Batch
+    {
+        const Mesh *mesh;
+        Shader *shader;
+        const Texture *texture;
+        unsigned int firstInstance;
+        unsigned int instanceCount;
+    };
+
+    // glMultiDrawElementsIndirect 的命令格式
+    struct DrawCommand
+    {
+        unsigned int count;
+        unsigned int instanceCount;
+        unsigned int firstIndex;
+        int baseVertex;
+        unsigned int baseInstance;
+    };
+
+    // 一次多重间接绘制：共用着色器、贴图、VAO 和索引类型的连续批次
+    struct Run
+    {
+        Shader *shader;
+        const Texture *texture;
+        unsigned int vertexArray;
+        GLenum indexType;
+        unsigned int firstCommand;
+        unsigned int commandCount;
+        unsigned long long triangles;
+        unsigned long long fetchBytes;
+    };
+
+    struct Pass
+    {
+        bool depthOnly;
+        std::vector<Batch> batches;
+        std::vector<Run> runs; // 只在开启多重间接绘制时生成
+    };
+
+    unsigned int instanceVBO;
+    size_t capacity; // 实例缓冲当前容量（字节）
+    bool depthStreams;
+    bool multiDraw;
+    unsigned int indirectBuffer;
+    size_t indirectCapacity; // 间接命令缓冲当前容量（字节）
+
+    std::vector<InstanceData> instances;
+    std::vector<DrawCommand> commands;
+    std::vector<Pass> passes;
+    RenderQueue queue;
+    glm::vec3 viewPosition;
+
+    // 普通着色器 → 实例化变体（保持引用，避免 ShaderLibrary 释放）
+    // 同时记下普通着色器的弱引用：它释放后地址可能被新的着色器复用，对应的项在 begin() 中清除
+    struct InstancedShader
+    {
+        std::weak_ptr<Shader> base;
+        std::shared_ptr<Shader> variant;
+    };
+    std::map<const Shader *, InstancedShader> instancedShaders;
+
+    Shader *instancedVariant(const std::shared_ptr<Shader> &shader);
+    void buildRuns(Pass &pass);
+    void drawRuns(const Pass &pass) const;
+};
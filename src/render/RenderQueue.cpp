@@ -0,0 +1,137 @@
+#include "RenderQueue.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+    const unsigned int PASS_BITS = 4;
+    const unsigned int PROGRAM_BITS = 10;
+    const unsigned int TEXTURE_BITS = 10;
+    const unsigned int MATERIAL_BITS = 8;
+    const unsigned int MESH_BITS = 12;
+    const unsigned int DEPTH_BITS = 20;
+
+    uint64_t field(unsigned int value, unsigned int bits)
+    {
+        return (uint64_t)value & ((1ull << bits) - 1);
+    }
+}
+
+RenderQueue::RenderQueue()
+    : policy(SORT_STATE), maxDistance(100.0f)
+{
+}
+
+void RenderQueue::clear()
+{
+    queue.clear();
+    states.clear();
+}
+
+void RenderQueue::add(unsigned int pass, unsigned int program, unsigned int texture, unsigned int material, unsigned int mesh,
+                      float distance)
+{
+    float normalized = std::min(std::max(distance / maxDistance, 0.0f), 1.0f);
+    unsigned int depth = (unsigned int)(normalized * ((1u << DEPTH_BITS) - 1));
+
+    // 状态部分：程序 | 贴图 | 材质 | mesh，共 40 位
+    uint64_t state = field(program, PROGRAM_BITS);
+    state = (state << TEXTURE_BITS) | field(texture, TEXTURE_BITS);
+    state = (state << MATERIAL_BITS) | field(material, MATERIAL_BITS);
+    state = (state << MESH_BITS) | field(mesh, MESH_BITS);
+    const unsigned int STATE_BITS = PROGRAM_BITS + TEXTURE_BITS + MATERIAL_BITS + MESH_BITS;
+
+    uint64_t key = field(pass, PASS_BITS) << (64 - PASS_BITS);
+    switch (policy)
+    {
+    case SORT_STATE:
+        key |= (state << DEPTH_BITS) | depth;
+        break;
+    case SORT_FRONT_TO_BACK:
+        key |= ((uint64_t)depth << STATE_BITS) | state;
+        break;
+    default:
+        key |= (uint64_t)queue.size(); // 提交顺序
+        break;
+    }
+
+    queue.push_back({key, (unsigned int)queue.size()});
+    states.push_back({program, texture, material, mesh});
+}
+
+void RenderQueue::sort()
+{
+    size_t count = queue.size();
+    if (count < 2)
+        return;
+
+    scratch.resize(count);
+    for (unsigned int shift = 0; shift < 64; shift += 8)
+    {
+        size_t histogram[256] = {};
+        for (const Item &item : queue)
+            ++histogram[(item.key >> shift) & 0xff];
+
+        // 所有键在这个字节上相同，排序结果不变
+        if (histogram[(queue[0].key >> shift) & 0xff] == count)
+            continue;
+
+        size_t offset = 0;
+        for (size_t &bucket : histogram)
+        {
+            size_t size = bucket;
+            bucket = offset;
+            offset += size;
+        }
+        for (const Item &item : queue)
+            scratch[histogram[(item.key >> shift) & 0xff]++] = item;
+        queue.swap(scratch);
+    }
+}
+
+RenderQueue::StateChanges RenderQueue::countStateChanges() const
+{
+    StateChanges changes;
+    const State *previous = nullptr;
+    for (const Item &item : queue)
+    {
+        const State &state = states[item.index];
+        if (!previous || state.program != previous->program)
+            ++changes.programs;
+        if (!previous || state.texture != previous->texture)
+            ++changes.textures;
+        if (!previous || state.material != previous->material)
+            ++changes.materials;
+        if (!previous || state.mesh != previous->mesh)
+            ++changes.meshes;
+        previous = &state;
+    }
+    return changes;
+}
+
+const char *RenderQueue::name(SortPolicy policy)
+{
+    switch (policy)
+    {
+    case SORT_NONE:
+        return "none";
+    case SORT_FRONT_TO_BACK:
+        return "depth";
+    default:
+        return "state";
+    }
+}
+
+bool RenderQueue::parse(const char *name, SortPolicy &policy)
+{
+    for (SortPolicy candidate : {SORT_NONE, SORT_STATE, SORT_FRONT_TO_BACK})
+    {
+        if (std::strcmp(name, RenderQueue::name(candidate)) == 0)
+        {
+            policy = candidate;
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "../object/Bounds.h"
+
+// 绘制排序策略
+enum SortPolicy
+{
+    SORT_NONE,          // 保持提交顺序
+    SORT_STATE,         // pass → 程序 → 贴图 → 材质 → mesh → 由近到远（默认：状态切换最少，同状态内仍由近到远）
+    SORT_FRONT_TO_BACK  // pass → 由近到远 → 程序 → 贴图 → 材质 → mesh（过度绘制最少，状态切换多）
+};
+
+// 渲染队列：每个绘制生成一个 64 位排序键，每帧用基数排序，按排序后的顺序提交
+// 键的布局（高位在前，SORT_STATE）：
+//   pass 4 | 程序 10 | 贴图 10 | 材质 8 | mesh 12 | 深度 20
+// 各字段取编号的低位，编号冲突只会让排序变差，不影响正确性（提交时仍按实际状态判断是否切换）
+class RenderQueue
+{
+public:
+    struct Item
+    {
+        uint64_t key;
+        unsigned int index; // 添加顺序，调用方据此找回自己的绘制数据
+    };
+
+    // 一帧内各类状态在提交顺序中发生变化的次数
+    struct StateChanges
+    {
+        unsigned int programs = 0;
+        unsigned int textures = 0;
+        unsigned int materials = 0;
+        unsigned int meshes = 0;
+    };
+
+    RenderQueue();
+
+    void setPolicy(SortPolicy policy) { this->policy = policy; }
+    SortPolicy getPolicy() const { return policy; }
+
+    // 深度字段的量化范围：[0, maxDistance] 线性映射到 20 位
+    void setMaxDistance(float maxDistance) { this->maxDistance = maxDistance; }
+
+    void clear();
+
+    // 添加一个绘制；distance 为到相机的距离（用于由近到远排序）
+    void add(unsigned int pass, unsigned int program, unsigned int texture, unsigned int material, unsigned int mesh,
+             float distance);
+
+    // 按键升序做 LSD 基数排序（每次 8 位，所有键在该字节相同时跳过）
+    void sort();
+
+    const std::vector<Item> &items() const { return queue; }
+
+    // 统计按当前顺序提交时各类状态的切换次数（第一次设置也算一次）
+    StateChanges countStateChanges() const;
+
+    // 包围体中心到相机的距离，作为深度字段的输入
+    // （不减去半径：墙面等大物体的包围球常常包含相机，减去半径会让它们排到最前面）
+    static float viewDistance(const Bounds &bounds, const glm::vec3 &eye)
+    {
+        return glm::length(bounds.sphereCenter - eye);
+    }
+
+    static const char *name(SortPolicy policy);
+    static bool parse(const char *name, SortPolicy &policy);
+
+private:
+    struct State
+    {
+        unsigned int program, texture, material, mesh;
+    };
+
+    SortPolicy policy;
+    float maxDistance;
+    std::vector<Item> queue;
+    std::vector<Item> scratch;
+    std::vector<State> states; // 按添加顺序保存，用于统计状态切换
+};
@@ -0,0 +1,143 @@
+#include "ShadowAtlas.h"
+
+#include <algorithm>
+#include <cstdint>
+
+ShadowAtlas::ShadowAtlas() : atlasSize(4096), packs(0)
+{
+}
+
+void ShadowAtlas::setSize(unsigned int size)
+{
+    atlasSize = size;
+    packed.clear(); // 预算变了：下次 pack 一定重新排布
+    tiles.clear();
+    firstTiles.clear();
+}
+
+unsigned int ShadowAtlas::tileSize(float pixels, unsigned int maxSize, unsigned int previous)
+{
+    unsigned int size = MIN_TILE_SIZE;
+    while (size < pixels && size < maxSize)
+        size *= 2;
+    if (previous > size && previous <= maxSize && pixels > previous * 0.375f)
+        size = previous;
+    return size;
+}
+
+bool ShadowAtlas::pack(const std::vector<Request> &requests)
+{
+    bool same = !tiles.empty() && requests.size() == packed.size();
+    for (size_t i = 0; same && i < requests.size(); ++i)
+    {
+        same = requests[i].size == packed[i].size && requests[i].tiles == packed[i].tiles &&
+               requests[i].importance == packed[i].importance;
+    }
+    if (same)
+        return false;
+    packed = requests;
+
+    // 1. 预算：总面积超出图集时，把 边长 / 重要性 最大的请求减半
+    std::vector<unsigned int> sizes;
+    uint64_t area = 0, budget = (uint64_t)atlasSize * atlasSize;
+    int tileCount = 0;
+    for (const Request &request : requests)
+    {
+        unsigned int size = std::min(std::max(request.size, (unsigned int)MIN_TILE_SIZE), atlasSize);
+        sizes.push_back(size);
+        area += (uint64_t)size * size * request.tiles;
+        tileCount += request.tiles;
+    }
+    while (area > budget)
+    {
+        int worst = -1;
+        float worstScore = 0.0f;
+        for (size_t i = 0; i < requests.size(); ++i)
+        {
+            float score = sizes[i] / std::max(requests[i].importance, 0.001f);
+            if (sizes[i] > MIN_TILE_SIZE && requests[i].tiles > 0 && score > worstScore)
+            {
+                worst = (int)i;
+                worstScore = score;
+            }
+        }
+        if (worst < 0)
+            break; // 全部已是最小图块仍放不下：排在后面的图块分配失败
+        area -= (uint64_t)sizes[worst] * sizes[worst] * 3 / 4 * requests[worst].tiles;
+        sizes[worst] /= 2;
+    }
+
+    // 2. 图块按边长从大到小放进四叉树（同样大小的保持请求顺序）
+    tiles.assign(tileCount, Tile{0, 0, 0});
+    firstTiles.clear();
+    std::vector<int> order;
+    for (size_t i = 0; i < requests.size(); ++i)
+    {
+        firstTiles.push_back((int)order.size());
+        for (int j = 0; j < requests[i].tiles; ++j)
+            order.push_back((int)i);
+    }
+    std::vector<int> sorted(order.size());
+    for (size_t i = 0; i < sorted.size(); ++i)
+        sorted[i] = (int)i;
+    std::stable_sort(sorted.begin(), sorted.end(), [&](int a, int b) { return sizes[order[a]] > sizes[order[b]]; });
+
+    nodes.clear();
+    nodes.push_back(Node{0, 0, atlasSize, -1, false});
+    for (int index : sorted)
+    {
+        unsigned int size = sizes[order[index]];
+        int node = allocate(0, size);
+        if (node >= 0)
+            tiles[index] = Tile{nodes[node].x, nodes[node].y, size};
+    }
+    ++packs;
+    return true;
+}
+
+int ShadowAtlas::allocate(int node, unsigned int size)
+{
+    if (nodes[node].used || nodes[node].size < size)
+        return -1;
+    if (nodes[node].size == size)
+    {
+        // 已拆分的节点里有其他图块，不能整块使用
+        if (nodes[node].children >= 0)
+            return -1;
+        nodes[node].used = true;
+        return node;
+    }
+    if (nodes[node].children < 0)
+    {
+        // 拆成 4 个子节点（push_back 可能让 nodes 重新分配，先取出需要的值）
+        unsigned int x = nodes[node].x, y = nodes[node].y, half = nodes[node].size / 2;
+        int first = (int)nodes.size();
+        for (unsigned int i = 0; i < 4; ++i)
+            nodes.push_back(Node{x + (i & 1) * half, y + (i >> 1) * half, half, -1, false});
+        nodes[node].children = first;
+    }
+    for (int i = 0; i < 4; ++i)
+    {
+        int result = allocate(nodes[node].children + i, size);
+        if (result >= 0)
+            return result;
+    }
+    return -1;
+}
+
+glm::vec4 ShadowAtlas::transform(int request, int index) const
+{
+    const Tile &t = tile(request, index);
+    if (t.size == 0)
+        return glm::vec4(0.0f);
+    float scale = 1.0f / atlasSize;
+    return glm::vec4(t.x * scale, t.y * scale, t.size * scale, 0.5f / t.size);
+}
+
+float ShadowAtlas::occupancy() const
+{
+    uint64_t area = 0;
+    for (const Tile &t : tiles)
+        area += (uint64_t)t.size * t.size;
+    return (float)((double)area / ((double)atlasSize * atlasSize));
+}
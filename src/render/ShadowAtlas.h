@@ -0,0 +1,68 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <vector>
+
+// 阴影图集的图块分配（只负责布局，深度纹理由调用方创建）：一张 size x size 的深度纹理按四叉树切成正方形图块，
+// 多个光源的阴影图（点光源立方体的 6 个面、平行光 / 聚光灯的单张图）都画在各自的图块里，着色器按图块变换采样
+// - 每个光源提交一个请求：图块边长（按屏幕覆盖计算，2 的幂）、图块数和重要性
+// - 总面积超出图集时，按 边长 / 重要性 从大到小把请求的边长减半，直到放得下（最小 MIN_TILE_SIZE）
+// - 图块按边长从大到小放进四叉树：都是 2 的幂、总面积不超过图集时一定放得下，不会产生碎片
+// 请求与上次相同时沿用原来的布局（图块里缓存的阴影图仍然有效），有变化时整体重新排布
+class ShadowAtlas
+{
+public:
+    static const unsigned int MIN_TILE_SIZE = 64;
+
+    struct Tile
+    {
+        unsigned int x, y, size; // 图集中的纹素位置和边长
+    };
+
+    struct Request
+    {
+        unsigned int size; // 期望的图块边长（2 的幂）
+        int tiles;         // 图块数（点光源 6 个，其余 1 个）
+        float importance;  // 重要性：预算不够时重要性低的先降分辨率
+    };
+
+    ShadowAtlas();
+
+    void setSize(unsigned int size);
+    unsigned int size() const { return atlasSize; }
+
+    // 按请求排布所有图块；布局发生变化（图块里原有的内容作废）时返回 true
+    bool pack(const std::vector<Request> &requests);
+
+    // 第 request 个请求的第 index 个图块；分配到的边长可能小于请求的边长
+    const Tile &tile(int request, int index) const { return tiles[firstTiles[request] + index]; }
+    // 图块在图集纹理坐标中的变换：xy 为偏移，z 为缩放，w 为半个纹素（图块内的归一化坐标）
+    glm::vec4 transform(int request, int index) const;
+
+    // 布局的版本号：每次重新排布加一（写进阴影缓存的签名）
+    unsigned int generation() const { return packs; }
+    // 已分配的面积占图集的比例
+    float occupancy() const;
+
+    // 覆盖的像素数 → 图块边长：向上取整到 2 的幂，限制在 [MIN_TILE_SIZE, maxSize]
+    // previous 为上次的边长：需要的尺寸没有小到 previous 的 3/8 以下时不缩小，避免在 2 的幂附近来回重排
+    static unsigned int tileSize(float pixels, unsigned int maxSize, unsigned int previous = 0);
+
+private:
+    struct Node
+    {
+        unsigned int x, y, size;
+        int children; // 第一个子节点的下标（4 个连续），-1 表示未拆分
+        bool used;
+    };
+
+    unsigned int atlasSize;
+    unsigned int packs;
+    std::vector<Request> packed; // 当前布局对应的请求
+    std::vector<Tile> tiles;
+    std::vector<int> firstTiles; // 每个请求的第一个图块在 tiles 中的下标
+    std::vector<Node> nodes;
+
+    // 在 node 的子树中分配 size x size 的图块，失败返回 -1
+    int allocate(int node, unsigned int size);
+};
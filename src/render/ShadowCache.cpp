@@ -0,0 +1,50 @@
+#include "ShadowCache.h"
+#include "../object/Object.h"
+
+#include <cstring>
+
+namespace
+{
+    // FNV-1a 64 位哈希
+    const uint64_t FNV_OFFSET = 14695981039346656037ull;
+    const uint64_t FNV_PRIME = 1099511628211ull;
+
+    void hashBytes(uint64_t &hash, const void *data, size_t size)
+    {
+        const unsigned char *bytes = (const unsigned char *)data;
+        for (size_t i = 0; i < size; ++i)
+        {
+            hash ^= bytes[i];
+            hash *= FNV_PRIME;
+        }
+    }
+}
+
+ShadowCache::ShadowCache()
+    : signature(0), valid(false), renders(0), reuses(0)
+{
+}
+
+bool ShadowCache::needsUpdate(const glm::mat4 &lightParams, const std::vector<Object *> &casters, int lodBias)
+{
+    uint64_t hash = FNV_OFFSET;
+    hashBytes(hash, &lightParams, sizeof(lightParams));
+    for (const Object *caster : casters)
+    {
+        unsigned int version = caster->getTransformVersion();
+        const Mesh *mesh = caster->getLodMesh(lodBias);
+        hashBytes(hash, &caster, sizeof(caster));
+        hashBytes(hash, &version, sizeof(version));
+        hashBytes(hash, &mesh, sizeof(mesh));
+    }
+
+    if (valid && hash == signature)
+    {
+        ++reuses;
+        return false;
+    }
+    signature = hash;
+    valid = true;
+    ++renders;
+    return true;
+}
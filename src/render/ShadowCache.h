@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+
+class Object;
+
+// 阴影图缓存的失效判断：记录上次渲染时光源参数和投射物体（指针 + 变换版本号）的签名，
+// 签名不变说明阴影图内容不会变化，可以直接沿用上次的结果
+class ShadowCache
+{
+public:
+    ShadowCache();
+
+    // 计算本帧的签名；与上次渲染时不同（或缓存已失效）返回 true，调用方需要重新渲染
+    // lightParams 包含所有影响阴影图的光源参数（光源矩阵、位置、远平面等）
+    // 投射物体使用的 LOD 网格（当前层次 + lodBias）也计入签名，层次切换时重新渲染
+    bool needsUpdate(const glm::mat4 &lightParams, const std::vector<Object *> &casters, int lodBias = 0);
+
+    // 强制下次重新渲染（例如阴影图被其他内容覆盖）
+    void invalidate() { valid = false; }
+
+    unsigned int renderCount() const { return renders; }
+    unsigned int reuseCount() const { return reuses; }
+
+private:
+    uint64_t signature;
+    bool valid;
+    unsigned int renders;
+    unsigned int reuses;
+};
@@ -0,0 +1,255 @@
+#include "ShadowCascades.h"
+#include "../object/Object.h"
+
+#include <glm/gtc/matrix_transform.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace
+{
+    // 不拟合时，切片包围球之外、朝向光源一侧还要包含的投射物体范围（世界单位），覆盖场景高度
+    const float CASTER_MARGIN = 20.0f;
+
+    // 拟合出的范围向外取整到 1/4 单位：物体小幅移动（如自转）时矩阵不变，阴影缓存照样命中
+    const float FIT_STEP = 0.25f;
+
+    // 固定阴影图的深度范围（远平面 30 - 近平面 1）；着色器中的深度偏移按这个范围调好，其他级联按比例换算
+    const float REFERENCE_DEPTH_RANGE = 29.0f;
+
+    // 包围球半径按 1/16 向上取整，相机移动时半径的浮点误差不会改变纹素大小
+    const float RADIUS_STEP = 1.0f / 16.0f;
+
+    float floorTo(float value, float step) { return std::floor(value / step) * step; }
+    float ceilTo(float value, float step) { return std::ceil(value / step) * step; }
+
+    // 光源空间中 [lo, hi] 与 x / y 范围 [minXY, maxXY] 是否重叠
+    bool overlapsXY(const glm::vec3 &lo, const glm::vec3 &hi, const glm::vec2 &minXY, const glm::vec2 &maxXY)
+    {
+        return lo.x <= maxXY.x && hi.x >= minXY.x && lo.y <= maxXY.y && hi.y >= minXY.y;
+    }
+}
+
+const char *ShadowCascades::name(ShadowQuality quality)
+{
+    switch (quality)
+    {
+    case SHADOW_QUALITY_LOW:
+        return "low";
+    case SHADOW_QUALITY_HIGH:
+        return "high";
+    default:
+        return "medium";
+    }
+}
+
+bool ShadowCascades::parse(const char *name, ShadowQuality &quality)
+{
+    for (ShadowQuality candidate : {SHADOW_QUALITY_LOW, SHADOW_QUALITY_MEDIUM, SHADOW_QUALITY_HIGH})
+    {
+        if (std::strcmp(name, ShadowCascades::name(candidate)) == 0)
+        {
+            quality = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+ShadowCascades::Settings ShadowCascades::preset(ShadowQuality quality)
+{
+    switch (quality)
+    {
+    case SHADOW_QUALITY_LOW:
+        return {0, 1024, 25.0f, 0.5f, 0.0f};
+    case SHADOW_QUALITY_HIGH:
+        return {4, 2048, 30.0f, 0.5f, 0.1f};
+    default:
+        return {3, 2048, 25.0f, 0.5f, 0.1f};
+    }
+}
+
+ShadowCascades::ShadowCascades() : config(preset(SHADOW_QUALITY_MEDIUM)), fitting(true), nearPlane(0.0f)
+{
+    for (int i = 0; i < MAX_CASCADES; ++i)
+    {
+        matrices[i] = glm::mat4(1.0f);
+        splits[i] = 0.0f;
+        depthRanges[i] = REFERENCE_DEPTH_RANGE;
+        texelSizes[i] = 0.0f;
+    }
+}
+
+void ShadowCascades::configure(const Settings &settings)
+{
+    config = settings;
+    if (config.count > MAX_CASCADES)
+        config.count = MAX_CASCADES;
+    if (config.count < 0)
+        config.count = 0;
+}
+
+void ShadowCascades::collectBounds(const glm::mat4 &lightRotation, const std::vector<Object *> &objects,
+                                   std::vector<LightBounds> &result)
+{
+    // 光源空间（只有旋转）中的范围：变换后 AABB 的外包盒与包围球外包盒的交集，旋转的球体范围不变；z 取反后为沿光线方向的深度
+    result.clear();
+    for (Object *obj : objects)
+    {
+        Bounds bounds = obj->getWorldBounds().transformed(lightRotation);
+        glm::vec3 lo = glm::max(bounds.aabbMin, bounds.sphereCenter - bounds.sphereRadius);
+        glm::vec3 hi = glm::min(bounds.aabbMax, bounds.sphereCenter + bounds.sphereRadius);
+        result.push_back({glm::vec3(lo.x, lo.y, -hi.z), glm::vec3(hi.x, hi.y, -lo.z)});
+    }
+}
+
+float ShadowCascades::casterNearDepth(const glm::vec2 &minXY, const glm::vec2 &maxXY, float fallback) const
+{
+    float nearDepth = fallback;
+    for (const LightBounds &caster : casterBounds)
+    {
+        if (overlapsXY(caster.lo, caster.hi, minXY, maxXY))
+            nearDepth = std::min(nearDepth, caster.lo.z);
+    }
+    return nearDepth;
+}
+
+bool ShadowCascades::updateFitted(const glm::mat4 &lightRotation)
+{
+    // x / y：可见接收物体和投射物体范围的交集（交集之外的接收物体不可能被遮挡，交集之外的投射物体投不到可见的地方）
+    // 深度：近平面取与该范围重叠的投射物体的最近深度，远平面取接收物体的最远深度
+    if (receiverBounds.empty() || casterBounds.empty())
+        return false;
+    glm::vec3 receiverLo(1.0e30f), receiverHi(-1.0e30f), casterLo(1.0e30f), casterHi(-1.0e30f);
+    for (const LightBounds &receiver : receiverBounds)
+    {
+        receiverLo = glm::min(receiverLo, receiver.lo);
+        receiverHi = glm::max(receiverHi, receiver.hi);
+    }
+    for (const LightBounds &caster : casterBounds)
+    {
+        casterLo = glm::min(casterLo, caster.lo);
+        casterHi = glm::max(casterHi, caster.hi);
+    }
+    glm::vec2 minXY = glm::max(glm::vec2(receiverLo), glm::vec2(casterLo));
+    glm::vec2 maxXY = glm::min(glm::vec2(receiverHi), glm::vec2(casterHi));
+    if (minXY.x >= maxXY.x || minXY.y >= maxXY.y)
+        return false;
+
+    minXY = glm::vec2(floorTo(minXY.x, FIT_STEP), floorTo(minXY.y, FIT_STEP));
+    maxXY = glm::vec2(ceilTo(maxXY.x, FIT_STEP), ceilTo(maxXY.y, FIT_STEP));
+    float farDepth = ceilTo(receiverHi.z, FIT_STEP);
+    float nearDepth = floorTo(casterNearDepth(minXY, maxXY, receiverLo.z), FIT_STEP) - FIT_STEP;
+
+    matrices[0] = glm::ortho(minXY.x, maxXY.x, minXY.y, maxXY.y, nearDepth, farDepth) * lightRotation;
+    splits[0] = 1.0e30f; // 不按距离淡出
+    depthRanges[0] = farDepth - nearDepth;
+    texelSizes[0] = std::max(maxXY.x - minXY.x, maxXY.y - minXY.y) / config.resolution;
+    return true;
+}
+
+void ShadowCascades::updateFixed(const glm::vec3 &lightDirection)
+{
+    // 以原点为中心的 20x20 正交投影，光源沿平行光反方向移动一段距离（与引入级联之前相同）
+    float near = 1.0f, far = near + REFERENCE_DEPTH_RANGE;
+    glm::mat4 projection = glm::ortho(-10.0f, 10.0f, -10.0f, 10.0f, near, far);
+    glm::mat4 view = glm::lookAt(-lightDirection * 10.0f, glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    matrices[0] = projection * view;
+    splits[0] = 1.0e30f; // 不按距离淡出
+    depthRanges[0] = REFERENCE_DEPTH_RANGE;
+    texelSizes[0] = 20.0f / config.resolution;
+}
+
+void ShadowCascades::update(const glm::mat4 &cameraView, float fovY, float aspect, float nearPlane, const glm::vec3 &lightDirection,
+                            const std::vector<Object *> &casters, const std::vector<Object *> &receivers)
+{
+    this->nearPlane = nearPlane;
+
+    // 光源空间的朝向（所有级联共用）：只有旋转，光线沿 -z 方向
+    glm::vec3 direction = glm::normalize(lightDirection);
+    glm::vec3 up = std::abs(direction.y) > 0.99f ? glm::vec3(0.0f, 0.0f, 1.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+    glm::mat4 lightRotation = glm::lookAt(glm::vec3(0.0f), direction, up);
+    if (fitting)
+    {
+        collectBounds(lightRotation, casters, casterBounds);
+        collectBounds(lightRotation, receivers, receiverBounds);
+    }
+
+    if (!cascaded())
+    {
+        // 拟合失败（没有可见的接收物体）时退回固定投影
+        if (!fitting || !updateFitted(lightRotation))
+            updateFixed(lightDirection);
+        return;
+    }
+
+    // 1. 切分距离：对数切分让每级的纹素密度与透视缩放匹配，均匀切分避免近处的级联过小
+    int count = config.count;
+    float far = std::max(config.distance, nearPlane * 2.0f);
+    for (int i = 0; i < count; ++i)
+    {
+        float t = (float)(i + 1) / count;
+        float logSplit = nearPlane * std::pow(far / nearPlane, t);
+        float uniformSplit = nearPlane + (far - nearPlane) * t;
+        splits[i] = config.splitLambda * logSplit + (1.0f - config.splitLambda) * uniformSplit;
+    }
+
+    glm::mat4 inverseView = glm::inverse(cameraView);
+    float tanY = std::tan(fovY * 0.5f), tanX = tanY * aspect;
+
+    for (int i = 0; i < count; ++i)
+    {
+        // 2. 切片的 8 个角（世界空间）和包围球；半径只取决于切片形状，与相机朝向无关
+        float depths[2] = {splitNear(i), splitFar(i)};
+        glm::vec3 corners[8];
+        glm::vec3 center(0.0f);
+        for (int j = 0; j < 8; ++j)
+        {
+            float z = depths[j >> 2];
+            glm::vec4 corner((j & 1 ? 1.0f : -1.0f) * tanX * z, (j & 2 ? 1.0f : -1.0f) * tanY * z, -z, 1.0f);
+            corners[j] = glm::vec3(inverseView * corner);
+            center += corners[j];
+        }
+        center /= 8.0f;
+        float radius = 0.0f;
+        for (const glm::vec3 &corner : corners)
+            radius = std::max(radius, glm::length(corner - center));
+        radius = std::ceil(radius / RADIUS_STEP) * RADIUS_STEP;
+
+        // 3. 纹素对齐：光源空间中的中心取整到纹素大小的倍数，光源朝向固定时整个阴影图只会按整纹素平移，
+        //    边缘不会随相机移动闪烁
+        float texel = 2.0f * radius / config.resolution;
+        glm::vec3 lightCenter = glm::vec3(lightRotation * glm::vec4(center, 1.0f));
+        glm::vec2 centerXY(std::round(lightCenter.x / texel) * texel, std::round(lightCenter.y / texel) * texel);
+        float centerDepth = -lightCenter.z;
+
+        // 4. 正交投影覆盖整个包围球；近平面向光源方向延伸到切片外的投射物体：
+        //    拟合时取与这一级重叠的投射物体的最近深度，否则固定退 CASTER_MARGIN
+        float farDepth = centerDepth + radius;
+        float nearDepth = centerDepth - radius;
+        if (fitting)
+            nearDepth = floorTo(casterNearDepth(centerXY - radius, centerXY + radius, nearDepth), FIT_STEP) - FIT_STEP;
+        else
+            nearDepth -= CASTER_MARGIN;
+
+        glm::mat4 projection = glm::ortho(centerXY.x - radius, centerXY.x + radius, centerXY.y - radius, centerXY.y + radius,
+                                          nearDepth, farDepth);
+        matrices[i] = projection * lightRotation;
+        depthRanges[i] = farDepth - nearDepth;
+        texelSizes[i] = texel;
+    }
+}
+
+void ShadowCascades::apply(ShadowBlock &block) const
+{
+    int count = layers();
+    for (int i = 0; i < MAX_CASCADES; ++i)
+    {
+        bool used = i < count;
+        block.cascadeMatrices[i] = used ? matrices[i] : glm::mat4(1.0f);
+        block.cascadeSplits[i] = used ? splits[i] : 0.0f;
+        block.cascadeBiasScale[i] = used ? REFERENCE_DEPTH_RANGE / depthRanges[i] : 1.0f;
+    }
+    block.cascadeCount = count;
+    block.cascadeBlend = cascaded() ? config.blend : 0.0f;
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <vector>
+
+#include "UniformBuffers.h"
+
+class Object;
+
+// 阴影质量预设：决定平行光级联的数量、每级分辨率和覆盖距离
+enum ShadowQuality
+{
+    SHADOW_QUALITY_LOW,    // 固定的单张 1024² 阴影图（不分级）
+    SHADOW_QUALITY_MEDIUM, // 3 级 2048²，覆盖 25 个单位（默认）
+    SHADOW_QUALITY_HIGH    // 4 级 2048²，覆盖 30 个单位
+};
+
+// 平行光级联阴影图（CSM）：把相机视锥体沿视线方向切成若干段，每段一张正交阴影图（深度纹理数组的一层），
+// 近处的段覆盖范围小、纹素密度高
+// - 切分位置在对数切分和均匀切分之间插值（splitLambda = 1 为纯对数）
+// - 每段用切片的包围球定出正交投影（半径与相机朝向无关），投影中心按纹素对齐，相机平移 / 旋转时阴影边缘不闪烁
+// - 着色器按片段的视空间深度选择级联，段末尾 blend 比例的范围内与下一级混合，最后一级在末尾淡出
+// 级联数为 0 时只有一张阴影图
+// 拟合（默认开启）：投影范围由物体包围体决定，不再依赖手调的常量
+// - 单张阴影图：x / y 取相机可见的接收物体与投射物体在光源空间中范围的交集，深度从最近的投射物体到最远的接收物体
+// - 级联：x / y 仍由切片包围球决定（保持稳定），近平面取与这一级重叠的投射物体的最近深度
+// 不拟合时单张阴影图为以原点为中心的 20x20 正交投影，级联的近平面固定向光源方向延伸 20 个单位
+class ShadowCascades
+{
+public:
+    static const int MAX_CASCADES = MAX_SHADOW_CASCADES;
+
+    struct Settings
+    {
+        int count;               // 级联数量（0 为固定的单张阴影图）
+        unsigned int resolution; // 每级阴影图的边长
+        float distance;          // 阴影覆盖的最远视距
+        float splitLambda;       // 对数切分的权重（0 均匀，1 对数）
+        float blend;             // 每级末尾与下一级混合的比例（0 关闭）
+    };
+
+    static const char *name(ShadowQuality quality);
+    static bool parse(const char *name, ShadowQuality &quality);
+    static Settings preset(ShadowQuality quality);
+
+    ShadowCascades();
+
+    void configure(const Settings &settings);
+    const Settings &settings() const { return config; }
+    void setFitting(bool enabled) { fitting = enabled; }
+
+    // 阴影图数组的层数（固定阴影图时为 1）
+    int layers() const { return config.count > 0 ? config.count : 1; }
+    bool cascaded() const { return config.count > 0; }
+
+    // 按相机视锥体重新计算每级的切分距离和光源矩阵
+    // casters：所有投射物体；receivers：相机可见的接收物体（只在拟合时使用）
+    void update(const glm::mat4 &cameraView, float fovY, float aspect, float nearPlane, const glm::vec3 &lightDirection,
+                const std::vector<Object *> &casters, const std::vector<Object *> &receivers);
+
+    const glm::mat4 &matrix(int cascade) const { return matrices[cascade]; }
+    // 第 cascade 级覆盖的视空间深度范围 [splitNear, splitFar]
+    float splitNear(int cascade) const { return cascade == 0 ? nearPlane : splits[cascade - 1]; }
+    float splitFar(int cascade) const { return splits[cascade]; }
+    // 每级阴影图一个纹素对应的世界空间尺寸
+    float texelSize(int cascade) const { return texelSizes[cascade]; }
+
+    // 写入 ShadowBlock 的级联部分
+    void apply(ShadowBlock &block) const;
+
+private:
+    // 物体在光源空间中的范围（x / y 为阴影图平面，z 为沿光线方向的深度）
+    struct LightBounds
+    {
+        glm::vec3 lo, hi;
+    };
+
+    Settings config;
+    bool fitting;
+    float nearPlane;
+    glm::mat4 matrices[MAX_CASCADES];
+    float splits[MAX_CASCADES];
+    float depthRanges[MAX_CASCADES]; // 正交投影的深度范围（世界单位），用于换算深度偏移
+    float texelSizes[MAX_CASCADES];
+    std::vector<LightBounds> casterBounds, receiverBounds;
+
+    static void collectBounds(const glm::mat4 &lightRotation, const std::vector<Object *> &objects, std::vector<LightBounds> &result);
+    // 与光源空间 x / y 范围重叠的投射物体的最近深度（没有时返回 fallback）
+    float casterNearDepth(const glm::vec2 &minXY, const glm::vec2 &maxXY, float fallback) const;
+    // 单张阴影图按包围体拟合，没有可见的接收物体时返回 false
+    bool updateFitted(const glm::mat4 &lightRotation);
+    void updateFixed(const glm::vec3 &lightDirection);
+};
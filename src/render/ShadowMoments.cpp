@@ -0,0 +1,229 @@
+#include "ShadowMoments.h"
+#include "GLState.h"
+#include "../ShaderLibrary.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace
+{
+    // 与 phone_fragment_shader.fs / shadow_moments_resolve_fragment_shader.fs 中的 EVSM 指数保持一致
+    const float EVSM_POSITIVE = 40.0f;
+    const float EVSM_NEGATIVE = 5.0f;
+
+    size_t texelBytes(GLenum internalFormat)
+    {
+        return internalFormat == GL_RGBA32F ? 16 : 8;
+    }
+}
+
+const char *ShadowMoments::name(ShadowFilter filter)
+{
+    switch (filter)
+    {
+    case SHADOW_FILTER_VSM:
+        return "vsm";
+    case SHADOW_FILTER_EVSM:
+        return "evsm";
+    default:
+        return "pcf";
+    }
+}
+
+bool ShadowMoments::parse(const char *name, ShadowFilter &filter)
+{
+    for (ShadowFilter candidate : {SHADOW_FILTER_PCF, SHADOW_FILTER_VSM, SHADOW_FILTER_EVSM})
+    {
+        if (std::strcmp(name, ShadowMoments::name(candidate)) == 0)
+        {
+            filter = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+const char *ShadowMoments::define(ShadowFilter filter)
+{
+    switch (filter)
+    {
+    case SHADOW_FILTER_VSM:
+        return "SHADOW_VSM";
+    case SHADOW_FILTER_EVSM:
+        return "SHADOW_EVSM";
+    default:
+        return nullptr;
+    }
+}
+
+ShadowMoments::ShadowMoments()
+    : filter(SHADOW_FILTER_PCF), internalFormat(GL_RG32F), dirSize(0), dirLayers(1), dirDownsample(1), dirMoments(0), pointMoments(0),
+      dirTemp{0, 0}, pointTemp{0, 0}, fbo(0), emptyVertexArray(0)
+{
+}
+
+ShadowMoments::~ShadowMoments()
+{
+    if (!enabled())
+        return;
+    unsigned int textures[] = {dirMoments, pointMoments, dirTemp[0], dirTemp[1], pointTemp[0], pointTemp[1]};
+    for (unsigned int texture : textures)
+        GLState::forgetTexture(texture);
+    glDeleteTextures(6, textures);
+    GLState::forgetFramebuffer(fbo);
+    glDeleteFramebuffers(1, &fbo);
+    GLState::forgetVertexArray(emptyVertexArray);
+    glDeleteVertexArrays(1, &emptyVertexArray);
+}
+
+unsigned int ShadowMoments::createTarget(GLenum target, unsigned int size, unsigned int layers, bool sampled)
+{
+    GLenum format = internalFormat == GL_RGBA32F ? GL_RGBA : GL_RG;
+    unsigned int texture;
+    glGenTextures(1, &texture);
+    GLState::bindTexture(0, target, texture);
+    if (target == GL_TEXTURE_2D_ARRAY)
+        glTexImage3D(target, 0, internalFormat, size, size, layers, 0, format, GL_FLOAT, NULL);
+    else if (target == GL_TEXTURE_CUBE_MAP)
+    {
+        for (unsigned int i = 0; i < 6; ++i)
+            glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, internalFormat, size, size, 0, format, GL_FLOAT, NULL);
+    }
+    else
+        glTexImage2D(target, 0, internalFormat, size, size, 0, format, GL_FLOAT, NULL);
+
+    // 临时纹理只用 texelFetch 读取；最终矩图用三线性过滤，预过滤之后一次采样即是区域平均
+    glTexParameteri(target, GL_TEXTURE_MIN_FILTER, sampled ? GL_LINEAR_MIPMAP_LINEAR : GL_NEAREST);
+    glTexParameteri(target, GL_TEXTURE_MAG_FILTER, sampled ? GL_LINEAR : GL_NEAREST);
+    glTexParameteri(target, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(target, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(target, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+    if (sampled)
+        glGenerateMipmap(target);
+    return texture;
+}
+
+void ShadowMoments::init(ShadowFilter filter, unsigned int dirDepthSize, unsigned int dirLayers)
+{
+    this->filter = filter;
+    if (!enabled())
+        return;
+
+    internalFormat = filter == SHADOW_FILTER_EVSM ? GL_RGBA32F : GL_RG32F;
+    dirSize = std::min(dirDepthSize, DIR_MAX_SIZE);
+    dirDownsample = dirDepthSize / dirSize;
+    this->dirLayers = dirLayers;
+
+    dirMoments = createTarget(GL_TEXTURE_2D_ARRAY, dirSize, dirLayers, true);
+    pointMoments = createTarget(GL_TEXTURE_CUBE_MAP, POINT_SIZE, 6, true);
+    for (int i = 0; i < 2; ++i)
+    {
+        dirTemp[i] = createTarget(GL_TEXTURE_2D_ARRAY, dirSize, dirLayers, false);
+        pointTemp[i] = createTarget(GL_TEXTURE_2D_ARRAY, POINT_SIZE, 6, false);
+    }
+
+    // 平行光阴影图范围之外视为无阴影：边框取深度 1.0 的矩
+    GLState::bindTexture(0, GL_TEXTURE_2D_ARRAY, dirMoments);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
+    float border[4] = {1.0f, 1.0f, 0.0f, 0.0f};
+    if (filter == SHADOW_FILTER_EVSM)
+    {
+        float positive = std::exp(EVSM_POSITIVE), negative = -std::exp(-EVSM_NEGATIVE);
+        border[0] = positive;
+        border[1] = positive * positive;
+        border[2] = negative;
+        border[3] = negative * negative;
+    }
+    glTexParameterfv(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_BORDER_COLOR, border);
+
+    // 立方体贴图的线性过滤跨越面的边界（否则每个面的边缘会出现接缝）
+    glEnable(GL_TEXTURE_CUBE_MAP_SEAMLESS);
+
+    glGenFramebuffers(1, &fbo);
+    glGenVertexArrays(1, &emptyVertexArray);
+
+    resolveShader = ShaderLibrary::get("../shader/shadow_moments_vertex_shader.vs", "../shader/shadow_moments_resolve_fragment_shader.fs");
+    resolveAtlasShader = ShaderLibrary::variant(*resolveShader, "ATLAS_SOURCE");
+    blurShader = ShaderLibrary::get("../shader/shadow_moments_vertex_shader.vs", "../shader/shadow_moments_blur_fragment_shader.fs");
+    resolveScaleHandle = resolveShader->handle("uScale");
+    resolveLayerHandle = resolveShader->handle("uLayer");
+    resolveAtlasTileHandle = resolveAtlasShader->handle("uTile");
+    blurLayerHandle = blurShader->handle("uLayer");
+    blurRadiusHandle = blurShader->handle("uRadius");
+    blurAxisHandle = blurShader->handle("uAxis");
+}
+
+void ShadowMoments::generate(GLenum sourceTarget, unsigned int source, int layer, const unsigned int *temp, unsigned int target,
+                             GLenum targetFace, unsigned int size, int radius)
+{
+    GLState::bindFramebuffer(GL_FRAMEBUFFER, fbo);
+    GLState::viewport(0, 0, size, size);
+
+    // 1. 深度 → 矩（降采样，resolve 着色器由调用方设置好）
+    GLState::bindTexture(0, sourceTarget, source);
+    glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, temp[0], 0, layer);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+
+    // 2. 水平模糊，3. 垂直模糊
+    blurShader->use();
+    blurShader->set(blurLayerHandle, layer);
+    blurShader->set(blurRadiusHandle, radius);
+    blurShader->set(blurAxisHandle, 0);
+    GLState::bindTexture(0, GL_TEXTURE_2D_ARRAY, temp[0]);
+    glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, temp[1], 0, layer);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+
+    blurShader->set(blurAxisHandle, 1);
+    GLState::bindTexture(0, GL_TEXTURE_2D_ARRAY, temp[1]);
+    if (targetFace == GL_TEXTURE_2D_ARRAY)
+        glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, target, 0, layer);
+    else
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, targetFace, target, 0);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+}
+
+void ShadowMoments::updateDirectional(unsigned int depthMap, unsigned int layerMask)
+{
+    GLState::bindVertexArray(emptyVertexArray);
+    glDisable(GL_DEPTH_TEST);
+    for (unsigned int layer = 0; layer < dirLayers; ++layer)
+    {
+        if (!(layerMask & (1u << layer)))
+            continue;
+        resolveShader->use();
+        resolveShader->set(resolveScaleHandle, dirDownsample);
+        resolveShader->set(resolveLayerHandle, (int)layer);
+        generate(GL_TEXTURE_2D_ARRAY, depthMap, layer, dirTemp, dirMoments, GL_TEXTURE_2D_ARRAY, dirSize, DIR_BLUR_RADIUS);
+    }
+    glEnable(GL_DEPTH_TEST);
+
+    GLState::bindTexture(0, GL_TEXTURE_2D_ARRAY, dirMoments);
+    glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+}
+
+void ShadowMoments::updatePoint(unsigned int atlas, const ShadowAtlas::Tile *faces)
+{
+    GLState::bindVertexArray(emptyVertexArray);
+    glDisable(GL_DEPTH_TEST);
+    for (int face = 0; face < 6; ++face)
+    {
+        resolveAtlasShader->use();
+        resolveAtlasShader->set(resolveAtlasTileHandle, glm::ivec4(faces[face].x, faces[face].y, faces[face].size, POINT_SIZE));
+        generate(GL_TEXTURE_2D, atlas, face, pointTemp, pointMoments, GL_TEXTURE_CUBE_MAP_POSITIVE_X + face, POINT_SIZE, POINT_BLUR_RADIUS);
+    }
+    glEnable(GL_DEPTH_TEST);
+
+    GLState::bindTexture(0, GL_TEXTURE_CUBE_MAP, pointMoments);
+    glGenerateMipmap(GL_TEXTURE_CUBE_MAP);
+}
+
+size_t ShadowMoments::gpuBytes() const
+{
+    if (!enabled())
+        return 0;
+    // 完整 mipmap 链约为第 0 层的 4/3
+    size_t dir = (size_t)dirSize * dirSize * dirLayers, point = (size_t)POINT_SIZE * POINT_SIZE * 6;
+    return (dir * 4 / 3 + dir * 2 + point * 4 / 3 + point * 2) * texelBytes(internalFormat);
+}
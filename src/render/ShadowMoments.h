@@ -0,0 +1,81 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <memory>
+
+#include "../Shader.h"
+#include "ShadowAtlas.h"
+
+// 阴影过滤方式
+enum ShadowFilter
+{
+    SHADOW_FILTER_PCF,  // 深度图 + 逐片段多次比较（默认）
+    SHADOW_FILTER_VSM,  // 方差阴影图：存 (d, d²)，按切比雪夫不等式估计可见比例
+    SHADOW_FILTER_EVSM  // 指数方差阴影图：存正负两个指数变换后的 (e, e²)，漏光更少
+};
+
+// 可预过滤的阴影图：阴影图（深度）更新后转换成矩（moments），做一次可分离的盒式模糊并生成 mipmap，
+// 光照时每个光源只需一次线性 + mipmap 过滤的采样
+// 三个全屏 pass（临时结果放在 2D 数组纹理中，点光源每个面一层）：
+//   1. 读深度（点光源从阴影图集中该面的图块读取）、转换成矩，按分辨率比做盒式降采样（每个深度纹素只读一次）
+//   2. 水平方向盒式模糊
+//   3. 垂直方向盒式模糊，写入最终的矩图（平行光为 2D 纹理数组的对应级联，点光源为立方体贴图的对应面）
+// 点光源逐面模糊，不跨越立方体贴图的接缝
+class ShadowMoments
+{
+public:
+    static const int DIR_BLUR_RADIUS = 2;   // 平行光：5 个纹素宽的盒式模糊，与 5x5 PCF 的范围相同
+    static const int POINT_BLUR_RADIUS = 1; // 点光源：矩图上 3 个纹素宽
+    static const unsigned int DIR_MAX_SIZE = 1024; // 平行光矩图的边长上限，更大的级联阴影图先降采样
+    static const unsigned int POINT_SIZE = 512;    // 点光源立方体矩图的边长，与图块大小无关（模糊范围对应的角度不随预算变化）
+
+    static const char *name(ShadowFilter filter);
+    static bool parse(const char *name, ShadowFilter &filter);
+    // 着色器中选择阴影查找方式的全局宏定义（PCF 返回 nullptr）
+    static const char *define(ShadowFilter filter);
+
+    ShadowMoments();
+    ~ShadowMoments();
+
+    // 创建矩图和 pass 使用的着色器（需在设置全局宏定义之后调用），filter 为 PCF 时什么都不做
+    void init(ShadowFilter filter, unsigned int dirDepthSize, unsigned int dirLayers);
+    bool enabled() const { return filter != SHADOW_FILTER_PCF; }
+
+    // 由深度图重新生成矩图（阴影图重新渲染后调用）
+    // 平行光只重新生成 layerMask 中的级联（第 i 位对应第 i 层）；点光源从阴影图集的 6 个图块生成立方体矩图
+    void updateDirectional(unsigned int depthMap, unsigned int layerMask);
+    void updatePoint(unsigned int atlas, const ShadowAtlas::Tile *faces);
+
+    unsigned int directionalMap() const { return dirMoments; }
+    unsigned int pointMap() const { return pointMoments; }
+
+    // 矩图占用的显存（含 mipmap 和临时纹理）
+    size_t gpuBytes() const;
+
+private:
+    ShadowFilter filter;
+    GLenum internalFormat; // VSM 两个分量，EVSM 四个分量
+    unsigned int dirSize;
+    unsigned int dirLayers; // 平行光级联数
+    int dirDownsample;      // 平行光深度图边长 / 矩图边长
+
+    unsigned int dirMoments;   // 最终矩图（2D 数组，每级一层，带 mipmap）
+    unsigned int pointMoments; // 立方体贴图（带 mipmap）
+    unsigned int dirTemp[2];   // 降采样 / 水平模糊的结果（每级一层）
+    unsigned int pointTemp[2]; // 同上（6 层，每面一层）
+    unsigned int fbo;
+    unsigned int emptyVertexArray; // 全屏三角形由 gl_VertexID 生成，核心模式仍需绑定 VAO
+
+    std::shared_ptr<Shader> resolveShader;     // 深度图 → 矩
+    std::shared_ptr<Shader> resolveAtlasShader; // 阴影图集中的一个图块 → 矩
+    std::shared_ptr<Shader> blurShader;        // 一个方向的模糊
+    UniformHandle resolveScaleHandle, resolveLayerHandle, resolveAtlasTileHandle;
+    UniformHandle blurLayerHandle, blurRadiusHandle, blurAxisHandle;
+
+    // sampled 为 true 时是带 mipmap、线性过滤的最终矩图，否则是只用 texelFetch 读取的临时纹理
+    unsigned int createTarget(GLenum target, unsigned int size, unsigned int layers, bool sampled);
+    // 用当前的 resolve 着色器把 source 转换成矩写入 temp[0] 的第 layer 层 → temp[1] → target 的 targetFace
+    // （2D 数组时为 GL_TEXTURE_2D_ARRAY，写入同一层）
+    void generate(GLenum sourceTarget, unsigned int source, int layer, const unsigned int *temp, unsigned int target,
+                  GLenum targetFace, unsigned int size, int radius);
+};
@@ -0,0 +1,131 @@
+#include "UniformBuffers.h"
+#include "../material/Material.h"
+
+#include <cstring>
+#include <iostream>
+
+const Material *UniformBuffers::materials[MAX_MATERIALS] = {};
+int UniformBuffers::materialCount = 0;
+
+namespace
+{
+    const size_t blockSizes[UNIFORM_BLOCK_COUNT] = {
+        sizeof(CameraBlock),
+        sizeof(LightBlock),
+        sizeof(ShadowBlock),
+        sizeof(MaterialBlock)};
+
+    const char *blockNames[UNIFORM_BLOCK_COUNT] = {
+        "CameraBlock",
+        "LightBlock",
+        "ShadowBlock",
+        "MaterialBlock"};
+}
+
+UniformBuffers::UniformBuffers()
+{
+    for (int i = 0; i < UNIFORM_BLOCK_COUNT; ++i)
+        buffers[i] = 0;
+}
+
+void UniformBuffers::init()
+{
+    glGenBuffers(UNIFORM_BLOCK_COUNT, buffers);
+    for (int i = 0; i < UNIFORM_BLOCK_COUNT; ++i)
+    {
+        glBindBuffer(GL_UNIFORM_BUFFER, buffers[i]);
+        glBufferData(GL_UNIFORM_BUFFER, blockSizes[i], NULL, GL_DYNAMIC_DRAW);
+        glBindBufferBase(GL_UNIFORM_BUFFER, i, buffers[i]);
+    }
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+void UniformBuffers::update(UniformBlockBinding binding, const void *data, size_t size)
+{
+    glBindBuffer(GL_UNIFORM_BUFFER, buffers[binding]);
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, size, data);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+void UniformBuffers::updateCamera(const CameraBlock &block)
+{
+    update(CAMERA_BLOCK_BINDING, &block, sizeof(block));
+}
+
+void UniformBuffers::updateLights(const LightBlock &block)
+{
+    update(LIGHT_BLOCK_BINDING, &block, sizeof(block));
+}
+
+void UniformBuffers::updateShadow(const ShadowBlock &block)
+{
+    update(SHADOW_BLOCK_BINDING, &block, sizeof(block));
+}
+
+void UniformBuffers::updateMaterials()
+{
+    MaterialBlock block;
+    std::memset(&block, 0, sizeof(block));
+    for (int i = 0; i < materialCount; ++i)
+    {
+        if (materials[i])
+            materials[i]->writeMaterialData(block.materials[i]);
+    }
+
+    // 只上传实际使用的部分
+    update(MATERIAL_BLOCK_BINDING, &block, sizeof(MaterialData) * (materialCount > 0 ? materialCount : 1));
+}
+
+UniformBuffers::~UniformBuffers()
+{
+    if (buffers[0] != 0)
+        glDeleteBuffers(UNIFORM_BLOCK_COUNT, buffers);
+}
+
+int UniformBuffers::bindingFor(const char *blockName)
+{
+    for (int i = 0; i < UNIFORM_BLOCK_COUNT; ++i)
+    {
+        if (std::strcmp(blockNames[i], blockName) == 0)
+            return i;
+    }
+    return -1;
+}
+
+int UniformBuffers::textureUnitFor(const char *samplerName)
+{
+    if (std::strcmp(samplerName, "uDiffuseMap") == 0)
+        return DIFFUSE_TEXTURE_UNIT;
+    if (std::strcmp(samplerName, "uShadowMap") == 0)
+        return SHADOW_TEXTURE_UNIT;
+    if (std::strcmp(samplerName, "uPointShadowMap") == 0)
+        return POINT_SHADOW_TEXTURE_UNIT;
+    return -1;
+}
+
+int UniformBuffers::registerMaterial(const Material *material)
+{
+    // 复用已注销的位置
+    for (int i = 0; i < materialCount; ++i)
+    {
+        if (materials[i] == nullptr)
+        {
+            materials[i] = material;
+            return i;
+        }
+    }
+
+    if (materialCount >= MAX_MATERIALS)
+    {
+        std::cout << "ERROR::MATERIAL::TOO_MANY_MATERIALS (max " << MAX_MATERIALS << ")" << std::endl;
+        return -1;
+    }
+    materials[materialCount] = material;
+    return materialCount++;
+}
+
+void UniformBuffers::unregisterMaterial(int index, const Material *material)
+{
+    if (index >= 0 && index < materialCount && materials[index] == material)
+        materials[index] = nullptr;
+}
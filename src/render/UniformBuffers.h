@@ -0,0 +1,129 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+class Material;
+
+// 所有着色器共享的 uniform block 绑定点（GLSL 4.1 不支持 layout(binding)，链接后由 Shader 按名字绑定）
+enum UniformBlockBinding
+{
+    CAMERA_BLOCK_BINDING = 0,   // CameraBlock：视图、投影、视点
+    LIGHT_BLOCK_BINDING = 1,    // LightBlock：平行光 + 点光源参数
+    SHADOW_BLOCK_BINDING = 2,   // ShadowBlock：平行光级联矩阵、点光源阴影参数
+    MATERIAL_BLOCK_BINDING = 3, // MaterialBlock：所有 Phong 材质，按 uMaterialIndex 索引
+    UNIFORM_BLOCK_COUNT
+};
+
+// 固定的纹理单元分配，采样器在链接后一次性设置好
+enum TextureUnit
+{
+    DIFFUSE_TEXTURE_UNIT = 0,
+    SHADOW_TEXTURE_UNIT = 1,
+    POINT_SHADOW_TEXTURE_UNIT = 2
+};
+
+// ---------------- 以下结构体与着色器中的 std140 布局一一对应 ----------------
+
+struct CameraBlock
+{
+    glm::mat4 view;
+    glm::mat4 projection;
+    glm::vec3 viewPos;
+    float pad0;
+};
+
+struct DirectionalLightData
+{
+    glm::vec3 direction;
+    float pad0;
+    glm::vec3 color;
+    float pad1;
+};
+
+struct PointLightData
+{
+    glm::vec3 position;
+    float pad0;
+    glm::vec3 color;
+    float constant; // std140 中 float 紧跟在 vec3 后面
+    float linear;
+    float quadratic;
+    float pad1[2];
+};
+
+struct LightBlock
+{
+    DirectionalLightData dirLight;
+    PointLightData pointLight;
+};
+
+// 平行光级联数量上限，需与着色器中 ShadowBlock 的 MAX_CASCADES 一致
+const int MAX_SHADOW_CASCADES = 4;
+
+struct ShadowBlock
+{
+    glm::mat4 cascadeMatrices[MAX_SHADOW_CASCADES]; // 每级的光源空间矩阵
+    glm::vec4 cascadeSplits;    // 每级覆盖到的视空间深度
+    glm::vec4 cascadeBiasScale; // 每级深度偏移的缩放（按正交投影的深度范围换算）
+    glm::vec3 pointLightPos;
+    float pointLightFar;
+    float lightBleedReduction; // 矩阴影（VSM / EVSM）的漏光抑制
+    int cascadeCount;
+    float cascadeBlend;        // 级联末尾的混合比例
+    float pad0;
+    glm::vec4 pointShadowTiles[6]; // 点光源每个面在阴影图集中的图块变换（ShadowAtlas::transform）
+};
+
+// 材质数量上限，需与 phone_fragment_shader.fs 中的 MAX_MATERIALS 一致
+const int MAX_MATERIALS = 64;
+
+struct MaterialData
+{
+    glm::vec3 diffuse;
+    float shininess;
+    glm::vec3 specular;
+    int useDiffuseMap;
+    glm::vec3 ambient;
+    float pad0;
+};
+
+struct MaterialBlock
+{
+    MaterialData materials[MAX_MATERIALS];
+};
+
+// 每帧写入一次的 uniform buffer，绑定在固定的绑定点上供所有程序共享
+class UniformBuffers
+{
+public:
+    UniformBuffers();
+
+    // 创建缓冲并绑定到各自的绑定点（需要已有 OpenGL 上下文）
+    void init();
+
+    void updateCamera(const CameraBlock &block);
+    void updateLights(const LightBlock &block);
+    void updateShadow(const ShadowBlock &block);
+
+    // 把所有已注册材质的参数写入 MaterialBlock
+    void updateMaterials();
+
+    ~UniformBuffers();
+
+    // 按名字查询 uniform block 的绑定点 / 采样器的纹理单元，未知名字返回 -1
+    static int bindingFor(const char *blockName);
+    static int textureUnitFor(const char *samplerName);
+
+    // 材质注册：返回材质在 MaterialBlock 中的下标，超出 MAX_MATERIALS 时返回 -1（未注册）
+    static int registerMaterial(const Material *material);
+    static void unregisterMaterial(int index, const Material *material);
+
+private:
+    unsigned int buffers[UNIFORM_BLOCK_COUNT];
+
+    static const Material *materials[MAX_MATERIALS];
+    static int materialCount;
+
+    void update(UniformBlockBinding binding, const void *data, size_t size);
+};
@@ -1,12 +1,15 @@
 #include "Texture.h"
+#include "../render/GLState.h"
+#include "../tool/CpuProfiler.h"
 #include "stb_image.h" // 记得 CMake 里 include_directories 指到了 include/
 
 #include <iostream>
 
 Texture::Texture(const std::string &path, bool flipVertical)
 {
+    CPU_PROFILE_SCOPE("texture load");
     glGenTextures(1, &id);
-    glBindTexture(GL_TEXTURE_2D, id);
+    GLState::bindTexture(0, GL_TEXTURE_2D, id);
 
     // 常规 wrap & filter 设置
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
@@ -16,7 +19,11 @@ Texture::Texture(const std::string &path, bool flipVertical)
 
     stbi_set_flip_vertically_on_load(flipVertical ? 1 : 0);
 
-    unsigned char *data = stbi_load(path.c_str(), &width, &height, &channels, 0);
+    unsigned char *data;
+    {
+        CPU_PROFILE_SCOPE("stbi_load");
+        data = stbi_load(path.c_str(), &width, &height, &channels, 0);
+    }
     if (!data)
     {
         std::cerr << "Failed to load texture image: " << path << std::endl;
@@ -48,14 +55,14 @@ Texture::Texture(const std::string &path, bool flipVertical)
 
 void Texture::bind(int unit) const
 {
-    glActiveTexture(GL_TEXTURE0 + unit);
-    glBindTexture(GL_TEXTURE_2D, id);
+    GLState::bindTexture(unit, GL_TEXTURE_2D, id);
 }
 
 Texture::~Texture()
 {
     if (id != 0)
     {
+        GLState::forgetTexture(id);
         glDeleteTextures(1, &id);
     }
 }
\ No newline at end of file
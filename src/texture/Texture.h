@@ -15,7 +15,7 @@ public:
     // flipVertical 表示是否上下翻转（大多数 2D 贴图都要翻一下）
     Texture(const std::string &path, bool flipVertical = true);
 
-    // 绑定到某个纹理单元（默认 0）
+    // 绑定到某个纹理单元（默认 0），该单元已经绑定了这张贴图时跳过
     void bind(int unit = 0) const;
 
     // 释放
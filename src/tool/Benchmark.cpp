@@ -0,0 +1,157 @@
+#include "Benchmark.h"
+#include "FrameStats.h"
+#include "../render/GLState.h"
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+
+namespace
+{
+    // phong 着色器每个物体每帧设置的 uniform（与主循环一致）
+    enum UniformKind
+    {
+        KIND_MAT4,
+        KIND_VEC3,
+        KIND_FLOAT,
+        KIND_INT
+    };
+
+    struct UniformUpload
+    {
+        const char *name;
+        UniformKind kind;
+    };
+
+    const UniformUpload phongUploads[] = {
+        {"uModel", KIND_MAT4},
+        {"uView", KIND_MAT4},
+        {"uProjection", KIND_MAT4},
+        {"uLightSpaceMatrix", KIND_MAT4},
+        {"uShadowMap", KIND_INT},
+        {"uPointShadowMap", KIND_INT},
+        {"uPointLightPos", KIND_VEC3},
+        {"uPointLightFar", KIND_FLOAT},
+        {"uViewPos", KIND_VEC3},
+        {"uDirLight.direction", KIND_VEC3},
+        {"uDirLight.color", KIND_VEC3},
+        {"uPointLight.position", KIND_VEC3},
+        {"uPointLight.color", KIND_VEC3},
+        {"uPointLight.constant", KIND_FLOAT},
+        {"uPointLight.linear", KIND_FLOAT},
+        {"uPointLight.quadratic", KIND_FLOAT},
+        {"uMaterialDiffuse", KIND_VEC3},
+        {"uMaterialSpecular", KIND_VEC3},
+        {"uMaterialAmbient", KIND_VEC3},
+        {"uMaterialShininess", KIND_FLOAT},
+        {"uUseDiffuseMap", KIND_INT},
+    };
+    const int uploadCount = sizeof(phongUploads) / sizeof(phongUploads[0]);
+
+    const glm::mat4 benchMatrix(1.0f);
+    const glm::vec3 benchVector(0.5f);
+
+    void uploadByLocation(int location, UniformKind kind)
+    {
+        switch (kind)
+        {
+        case KIND_MAT4:
+            glUniformMatrix4fv(location, 1, GL_FALSE, glm::value_ptr(benchMatrix));
+            break;
+        case KIND_VEC3:
+            glUniform3fv(location, 1, glm::value_ptr(benchVector));
+            break;
+        case KIND_FLOAT:
+            glUniform1f(location, 1.0f);
+            break;
+        case KIND_INT:
+            glUniform1i(location, 1);
+            break;
+        }
+    }
+
+    template <typename Fn>
+    double measureNsPerDraw(int draws, Fn &&fn)
+    {
+        glFinish();
+        auto begin = std::chrono::steady_clock::now();
+        for (int i = 0; i < draws; ++i)
+            fn();
+        glFinish();
+        double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - begin).count();
+        return ns / draws;
+    }
+}
+
+void Benchmark::uniforms(const Shader &shader, int draws)
+{
+    GLState::useProgram(shader.ID);
+
+    // 1. 旧实现：每个 uniform 都构造 std::string 并调用 glGetUniformLocation
+    double legacyNs = measureNsPerDraw(draws, [&]()
+                                       {
+        for (int u = 0; u < uploadCount; ++u)
+        {
+            const std::string name = phongUploads[u].name;
+            uploadByLocation(glGetUniformLocation(shader.ID, name.c_str()), phongUploads[u].kind);
+        } });
+
+    // 2. 按名字设置：在链接后反射的有序表中二分查找
+    double byNameNs = measureNsPerDraw(draws, [&]()
+                                       {
+        for (int u = 0; u < uploadCount; ++u)
+            uploadByLocation(shader.handle(phongUploads[u].name).location, phongUploads[u].kind); });
+
+    // 3. 预取句柄：热循环中没有任何字符串操作
+    UniformHandle handles[uploadCount];
+    for (int u = 0; u < uploadCount; ++u)
+        handles[u] = shader.handle(phongUploads[u].name);
+    double handleNs = measureNsPerDraw(draws, [&]()
+                                       {
+        for (int u = 0; u < uploadCount; ++u)
+            uploadByLocation(handles[u].location, phongUploads[u].kind); });
+
+    std::printf("uniform upload benchmark (%d uniforms/draw, %d draws)\n", uploadCount, draws);
+    std::printf("  glGetUniformLocation + std::string : %9.1f ns/draw\n", legacyNs);
+    std::printf("  reflected table lookup by name     : %9.1f ns/draw\n", byNameNs);
+    std::printf("  prefetched UniformHandle           : %9.1f ns/draw\n", handleNs);
+}
+
+void Benchmark::compare(const char *title, const std::vector<Variant> &variants, int iterations)
+{
+    unsigned int query = 0;
+    glGenQueries(1, &query);
+
+    std::printf("%s (%d iterations)\n", title, iterations);
+    for (const Variant &variant : variants)
+    {
+        // 预热：第一次运行包含驱动的延迟编译等开销
+        variant.run();
+        glFinish();
+
+        unsigned int drawsBefore = FrameStats::drawCalls;
+        double submitMs = 0.0, gpuMs = 0.0;
+        auto begin = std::chrono::steady_clock::now();
+        for (int i = 0; i < iterations; ++i)
+        {
+            glBeginQuery(GL_TIME_ELAPSED, query);
+            auto submitBegin = std::chrono::steady_clock::now();
+            variant.run();
+            submitMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - submitBegin).count();
+            glEndQuery(GL_TIME_ELAPSED);
+
+            GLuint64 elapsedNs = 0;
+            glGetQueryObjectui64v(query, GL_QUERY_RESULT, &elapsedNs);
+            gpuMs += elapsedNs / 1.0e6;
+        }
+        glFinish();
+        double totalMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+        unsigned int draws = FrameStats::drawCalls - drawsBefore;
+
+        std::printf("  %-24s: submit %9.3f ms  gpu %9.3f ms  total %9.3f ms  draws %6.1f  (per iteration)\n",
+                    variant.name.c_str(), submitMs / iterations, gpuMs / iterations, totalMs / iterations,
+                    (double)draws / iterations);
+    }
+
+    glDeleteQueries(1, &query);
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include "../Shader.h"
+
+#include <functional>
+#include <string>
+#include <vector>
+
+// 离屏模式下的微基准测试（--bench <name>），运行结束后直接退出
+class Benchmark
+{
+public:
+    // 每次绘制需要上传的 uniform 开销：
+    // 旧方式（每次 glGetUniformLocation + 临时 std::string）、按名字查反射表、预取句柄
+    static void uniforms(const Shader &shader, int draws);
+
+    // 比较同一工作的几种实现：每种先预热一次，再运行 iterations 次，
+    // 输出每次的 CPU 提交时间、GPU 时间（GL_TIME_ELAPSED）、含 glFinish 的总时间和 draw call 数
+    struct Variant
+    {
+        std::string name;
+        std::function<void()> run;
+    };
+    static void compare(const char *title, const std::vector<Variant> &variants, int iterations);
+};
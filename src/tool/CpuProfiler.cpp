@@ -0,0 +1,101 @@
+#include "CpuProfiler.h"
+
+#include <cstdio>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+std::atomic<bool> CpuProfiler::enabled(false);
+const std::chrono::steady_clock::time_point CpuProfiler::epoch = std::chrono::steady_clock::now();
+
+namespace
+{
+    // 一个线程的环形缓冲：只有所属线程写入，head 用 release 发布，导出时 acquire 读取
+    struct ThreadBuffer
+    {
+        unsigned int threadId;
+        std::atomic<uint64_t> head{0};
+        std::vector<CpuProfiler::Event> events;
+
+        explicit ThreadBuffer(unsigned int threadId) : threadId(threadId), events(CpuProfiler::BUFFER_CAPACITY) {}
+    };
+
+    std::mutex registryMutex;
+    std::vector<std::unique_ptr<ThreadBuffer>> registry;
+
+    ThreadBuffer *threadBuffer()
+    {
+        thread_local ThreadBuffer *buffer = nullptr;
+        if (!buffer)
+        {
+            std::lock_guard<std::mutex> lock(registryMutex);
+            registry.push_back(std::make_unique<ThreadBuffer>((unsigned int)registry.size() + 1));
+            buffer = registry.back().get();
+        }
+        return buffer;
+    }
+
+    // 事件名写进 JSON 字符串时转义引号和反斜杠
+    void writeEscaped(FILE *file, const char *text)
+    {
+        for (; *text; ++text)
+        {
+            if (*text == '"' || *text == '\\')
+                std::fputc('\\', file);
+            std::fputc(*text, file);
+        }
+    }
+}
+
+void CpuProfiler::record(const char *name, int64_t startNs, int64_t durationNs)
+{
+    ThreadBuffer *buffer = threadBuffer();
+    uint64_t head = buffer->head.load(std::memory_order_relaxed);
+    buffer->events[head & (BUFFER_CAPACITY - 1)] = {name, startNs, durationNs};
+    buffer->head.store(head + 1, std::memory_order_release);
+}
+
+uint64_t CpuProfiler::eventCount()
+{
+    std::lock_guard<std::mutex> lock(registryMutex);
+    uint64_t count = 0;
+    for (const auto &buffer : registry)
+        count += buffer->head.load(std::memory_order_acquire);
+    return count;
+}
+
+bool CpuProfiler::writeChromeTrace(const std::string &path)
+{
+    FILE *file = std::fopen(path.c_str(), "w");
+    if (!file)
+    {
+        std::cout << "Failed to write CPU trace: " << path << std::endl;
+        return false;
+    }
+
+    // 时间单位为微秒；"X" 为带持续时间的完整事件，同一线程内按嵌套关系显示
+    std::fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    bool first = true;
+    std::lock_guard<std::mutex> lock(registryMutex);
+    for (const auto &buffer : registry)
+    {
+        uint64_t head = buffer->head.load(std::memory_order_acquire);
+        uint64_t begin = head > BUFFER_CAPACITY ? head - BUFFER_CAPACITY : 0;
+        for (uint64_t i = begin; i < head; ++i)
+        {
+            const Event &event = buffer->events[i & (BUFFER_CAPACITY - 1)];
+            std::fprintf(file, "%s{\"name\":\"", first ? "" : ",\n");
+            writeEscaped(file, event.name);
+            std::fprintf(file, "\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+                         buffer->threadId, event.startNs / 1000.0, event.durationNs / 1000.0);
+            first = false;
+        }
+        std::fprintf(file, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"%s\"}}",
+                     first ? "" : ",\n", buffer->threadId, buffer->threadId == 1 ? "main" : "worker");
+        first = false;
+    }
+    std::fprintf(file, "\n]}\n");
+    std::fclose(file);
+    return true;
+}
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+// CPU 分段计时：CPU_PROFILE_SCOPE("name") 记录所在作用域的开始时间和持续时间，
+// 导出为 Chrome trace event JSON（chrome://tracing 或 ui.perfetto.dev 直接打开）
+// 每个线程第一次记录时分配自己的环形缓冲（只有注册这一步加锁），之后写入不加锁，
+// 缓冲写满后覆盖最旧的事件；一次记录只有两次读时钟和一次写入
+// 运行时默认关闭（每个作用域只多一次判断）；构建时关闭 CG_CPU_PROFILER 后宏展开为空
+class CpuProfiler
+{
+public:
+    // 每个线程环形缓冲的事件数（2 的幂）
+    static const uint32_t BUFFER_CAPACITY = 1 << 16;
+
+    struct Event
+    {
+        const char *name; // 字符串常量，导出时才读取
+        int64_t startNs;  // 相对 CpuProfiler 启动时刻
+        int64_t durationNs;
+    };
+
+    class Scope
+    {
+    public:
+        explicit Scope(const char *name) : name(enabled.load(std::memory_order_relaxed) ? name : nullptr)
+        {
+            if (this->name)
+                startNs = now();
+        }
+        ~Scope()
+        {
+            if (name)
+                record(name, startNs, now() - startNs);
+        }
+
+    private:
+        const char *name;
+        int64_t startNs = 0;
+    };
+
+    // 依次执行的多个阶段：next() 结束当前阶段并开始下一个，用于没有独立作用域的长函数（如主循环）
+    class Phase
+    {
+    public:
+        explicit Phase(const char *name) { start(name, now()); }
+        ~Phase() { end(); }
+
+        void next(const char *name)
+        {
+            int64_t timeNs = now();
+            stop(timeNs);
+            start(name, timeNs);
+        }
+        void end() { stop(now()); }
+
+    private:
+        const char *name = nullptr;
+        int64_t startNs = 0;
+
+        void start(const char *name, int64_t timeNs)
+        {
+            this->name = enabled.load(std::memory_order_relaxed) ? name : nullptr;
+            startNs = timeNs;
+        }
+        void stop(int64_t timeNs)
+        {
+            if (name)
+                record(name, startNs, timeNs - startNs);
+            name = nullptr;
+        }
+    };
+
+    static void setEnabled(bool value) { enabled.store(value, std::memory_order_relaxed); }
+    static bool isEnabled() { return enabled.load(std::memory_order_relaxed); }
+
+    static int64_t now()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count();
+    }
+
+    // 写入当前线程的环形缓冲
+    static void record(const char *name, int64_t startNs, int64_t durationNs);
+
+    // 已记录的事件总数（包括被覆盖的）
+    static uint64_t eventCount();
+
+    // 导出所有线程的事件；需在其他线程不再记录时调用
+    static bool writeChromeTrace(const std::string &path);
+
+private:
+    static std::atomic<bool> enabled;
+    static const std::chrono::steady_clock::time_point epoch;
+};
+
+#ifdef CG_CPU_PROFILER
+#define CPU_PROFILE_CONCAT_INNER(a, b) a##b
+#define CPU_PROFILE_CONCAT(a, b) CPU_PROFILE_CONCAT_INNER(a, b)
+#define CPU_PROFILE_SCOPE(name) CpuProfiler::Scope CPU_PROFILE_CONCAT(cpuProfileScope, __LINE__)(name)
+#define CPU_PROFILE_FUNCTION() CPU_PROFILE_SCOPE(__func__)
+#define CPU_PROFILE_PHASE(phase, name) CpuProfiler::Phase phase(name)
+#define CPU_PROFILE_NEXT(phase, name) phase.next(name)
+#define CPU_PROFILE_END(phase) phase.end()
+#else
+#define CPU_PROFILE_SCOPE(name) ((void)0)
+#define CPU_PROFILE_FUNCTION() ((void)0)
+#define CPU_PROFILE_PHASE(phase, name) ((void)0)
+#define CPU_PROFILE_NEXT(phase, name) ((void)0)
+#define CPU_PROFILE_END(phase) ((void)0)
+#endif
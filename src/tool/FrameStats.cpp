@@ -0,0 +1,209 @@
+#include "FrameStats.h"
+
+#include <algorithm>
+#include <cstdio>
+
+unsigned int FrameStats::drawCalls = 0;
+unsigned long long FrameStats::triangles = 0;
+unsigned long long FrameStats::vertexBytes = 0;
+unsigned int FrameStats::visibleObjects = 0;
+unsigned int FrameStats::culledObjects = 0;
+unsigned int FrameStats::shadowCasters = 0;
+unsigned int FrameStats::culledCasters = 0;
+unsigned int FrameStats::skippedFaces = 0;
+unsigned int FrameStats::shadowMapsRendered = 0;
+unsigned int FrameStats::shadowMapsReused = 0;
+unsigned int FrameStats::programChanges = 0;
+unsigned int FrameStats::textureChanges = 0;
+unsigned int FrameStats::materialChanges = 0;
+unsigned int FrameStats::meshChanges = 0;
+unsigned int FrameStats::glCallsIssued = 0;
+unsigned int FrameStats::glCallsElided = 0;
+
+FrameStats::FrameStats() : frameIndex(0), printedFrames(0)
+{
+    for (int i = 0; i < QUERY_RING_SIZE; ++i)
+    {
+        queries[i] = 0;
+        fragmentQueries[i] = 0;
+        fragmentQueryUsed[i] = false;
+        queryFrame[i] = -1;
+    }
+}
+
+void FrameStats::init()
+{
+    glGenQueries(QUERY_RING_SIZE, queries);
+    glGenQueries(QUERY_RING_SIZE, fragmentQueries);
+}
+
+void FrameStats::beginFrame()
+{
+    int slot = frameIndex % QUERY_RING_SIZE;
+
+    // 环形缓冲中这个位置的查询还没读出来（GPU 落后太多），只能等待
+    if (queryFrame[slot] >= 0)
+        resolveQuery(slot, true);
+
+    // 顺便收取已经就绪的旧查询
+    for (int i = 0; i < QUERY_RING_SIZE; ++i)
+    {
+        if (queryFrame[i] >= 0)
+            resolveQuery(i, false);
+    }
+    printReadyFrames();
+
+    drawCalls = 0;
+    triangles = 0;
+    vertexBytes = 0;
+    visibleObjects = 0;
+    culledObjects = 0;
+    shadowCasters = 0;
+    culledCasters = 0;
+    skippedFaces = 0;
+    shadowMapsRendered = 0;
+    shadowMapsReused = 0;
+    programChanges = 0;
+    textureChanges = 0;
+    materialChanges = 0;
+    meshChanges = 0;
+    glCallsIssued = 0;
+    glCallsElided = 0;
+    records.push_back({0.0, -1.0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, -1, 0, 0, 0, 0, 0, 0});
+    queryFrame[slot] = frameIndex;
+    fragmentQueryUsed[slot] = false;
+    glBeginQuery(GL_TIME_ELAPSED, queries[slot]);
+    frameStart = std::chrono::steady_clock::now();
+}
+
+void FrameStats::endFrame()
+{
+    glEndQuery(GL_TIME_ELAPSED);
+
+    FrameRecord &record = records[frameIndex];
+    record.cpuMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - frameStart).count();
+    record.drawCalls = drawCalls;
+    record.triangles = triangles;
+    record.vertexBytes = vertexBytes;
+    record.visibleObjects = visibleObjects;
+    record.culledObjects = culledObjects;
+    record.shadowCasters = shadowCasters;
+    record.culledCasters = culledCasters;
+    record.skippedFaces = skippedFaces;
+    record.shadowMapsRendered = shadowMapsRendered;
+    record.shadowMapsReused = shadowMapsReused;
+    record.programChanges = programChanges;
+    record.textureChanges = textureChanges;
+    record.materialChanges = materialChanges;
+    record.meshChanges = meshChanges;
+    record.glCallsIssued = glCallsIssued;
+    record.glCallsElided = glCallsElided;
+
+    ++frameIndex;
+}
+
+void FrameStats::beginShadedFragments()
+{
+    int slot = frameIndex % QUERY_RING_SIZE;
+    fragmentQueryUsed[slot] = true;
+    glBeginQuery(GL_SAMPLES_PASSED, fragmentQueries[slot]);
+}
+
+void FrameStats::endShadedFragments()
+{
+    glEndQuery(GL_SAMPLES_PASSED);
+}
+
+bool FrameStats::resolveQuery(int slot, bool wait)
+{
+    if (!wait)
+    {
+        int available = 0;
+        glGetQueryObjectiv(queries[slot], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available)
+            return false;
+    }
+
+    GLuint64 elapsedNs = 0;
+    glGetQueryObjectui64v(queries[slot], GL_QUERY_RESULT, &elapsedNs);
+    records[queryFrame[slot]].gpuMs = elapsedNs / 1.0e6;
+    // 片段查询在时间查询之前结束，时间查询就绪时它也已经就绪
+    if (fragmentQueryUsed[slot])
+    {
+        GLuint64 samples = 0;
+        glGetQueryObjectui64v(fragmentQueries[slot], GL_QUERY_RESULT, &samples);
+        records[queryFrame[slot]].shadedFragments = (long long)samples;
+    }
+    queryFrame[slot] = -1;
+    return true;
+}
+
+// 按帧号顺序输出已经拿到 GPU 时间的帧
+void FrameStats::printReadyFrames()
+{
+    while (printedFrames < frameIndex && records[printedFrames].gpuMs >= 0.0)
+    {
+        const FrameRecord &record = records[printedFrames];
+        std::printf("frame %4d: cpu %8.3f ms  gpu %8.3f ms  draws %u  tris %llu  vertex data %.2f MB  visible %u  culled %u  casters %u  culled casters %u  skipped faces %u  shadow maps %u rendered %u cached  shaded fragments %lld  state changes program %u texture %u material %u mesh %u  gl calls %u issued %u elided\n",
+                    printedFrames, record.cpuMs, record.gpuMs, record.drawCalls, record.triangles, record.vertexBytes / (1024.0 * 1024.0),
+                    record.visibleObjects, record.culledObjects,
+                    record.shadowCasters, record.culledCasters, record.skippedFaces,
+                    record.shadowMapsRendered, record.shadowMapsReused, record.shadedFragments,
+                    record.programChanges, record.textureChanges, record.materialChanges, record.meshChanges,
+                    record.glCallsIssued, record.glCallsElided);
+        ++printedFrames;
+    }
+}
+
+void FrameStats::finish()
+{
+    for (int i = 0; i < QUERY_RING_SIZE; ++i)
+    {
+        if (queryFrame[i] >= 0)
+            resolveQuery(i, true);
+    }
+    printReadyFrames();
+
+    if (records.empty())
+        return;
+
+    // 第一帧包含驱动的延迟初始化，不计入汇总
+    size_t first = records.size() > 1 ? 1 : 0;
+    double cpuSum = 0.0, gpuSum = 0.0, triangleSum = 0.0, vertexByteSum = 0.0, fragmentSum = 0.0, stateChangeSum = 0.0;
+    double issuedSum = 0.0, elidedSum = 0.0;
+    double cpuMin = records[first].cpuMs, cpuMax = records[first].cpuMs;
+    double gpuMin = records[first].gpuMs, gpuMax = records[first].gpuMs;
+    for (size_t i = first; i < records.size(); ++i)
+    {
+        cpuSum += records[i].cpuMs;
+        gpuSum += records[i].gpuMs;
+        triangleSum += (double)records[i].triangles;
+        vertexByteSum += (double)records[i].vertexBytes;
+        fragmentSum += (double)std::max(records[i].shadedFragments, 0LL);
+        stateChangeSum += records[i].programChanges + records[i].textureChanges + records[i].materialChanges + records[i].meshChanges;
+        issuedSum += records[i].glCallsIssued;
+        elidedSum += records[i].glCallsElided;
+        cpuMin = std::min(cpuMin, records[i].cpuMs);
+        cpuMax = std::max(cpuMax, records[i].cpuMs);
+        gpuMin = std::min(gpuMin, records[i].gpuMs);
+        gpuMax = std::max(gpuMax, records[i].gpuMs);
+    }
+    double count = (double)(records.size() - first);
+    // 三角形吞吐量：提交的三角形总数 / GPU 总时间
+    // 每个着色片段的 GPU 时间：GPU 总时间 / 主 pass 片段总数，阴影图都走缓存（如 --light-speed 0）时近似主 pass 的逐片段开销
+    std::printf("summary (%d frames, first excluded): cpu avg %.3f ms [%.3f, %.3f]  gpu avg %.3f ms [%.3f, %.3f]  draws %u  tris avg %.0f  throughput %.2f Mtris/s  vertex data avg %.2f MB  shaded fragments avg %.0f (%.2f ns gpu each)  state changes avg %.1f  gl calls avg %.1f issued %.1f elided\n",
+                (int)records.size(), cpuSum / count, cpuMin, cpuMax, gpuSum / count, gpuMin, gpuMax,
+                records.back().drawCalls, triangleSum / count, gpuSum > 0.0 ? triangleSum / gpuSum / 1.0e3 : 0.0,
+                vertexByteSum / count / (1024.0 * 1024.0), fragmentSum / count,
+                fragmentSum > 0.0 ? gpuSum / fragmentSum * 1.0e6 : 0.0, stateChangeSum / count,
+                issuedSum / count, elidedSum / count);
+}
+
+FrameStats::~FrameStats()
+{
+    if (queries[0] != 0)
+    {
+        glDeleteQueries(QUERY_RING_SIZE, queries);
+        glDeleteQueries(QUERY_RING_SIZE, fragmentQueries);
+    }
+}
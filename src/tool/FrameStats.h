@@ -0,0 +1,134 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <chrono>
+#include <vector>
+
+// 逐帧性能统计：CPU 时间、GPU 时间（GL_TIME_ELAPSED 查询）、draw call 数和主 pass 着色的片段数（GL_SAMPLES_PASSED 查询）
+// GPU 查询使用环形缓冲，读取的是几帧之前的结果，避免等待 GPU 造成流水线停顿
+class FrameStats
+{
+public:
+    // 当前帧发出的 draw call 数、提交的三角形数和引用的顶点 + 索引数据量（不计缓存命中，作为带宽上限），
+    // 每次 glDraw* 之后调用 addDrawCall()
+    static unsigned int drawCalls;
+    static unsigned long long triangles;
+    static unsigned long long vertexBytes;
+    static void addDrawCall(unsigned long long drawTriangles = 0, unsigned long long drawBytes = 0)
+    {
+        ++drawCalls;
+        triangles += drawTriangles;
+        vertexBytes += drawBytes;
+    }
+
+    // 当前帧视锥体剔除后可见 / 被剔除的物体数
+    static unsigned int visibleObjects;
+    static unsigned int culledObjects;
+    static void addCulling(unsigned int visible, unsigned int culled)
+    {
+        visibleObjects += visible;
+        culledObjects += culled;
+    }
+
+    // 当前帧各阴影 pass 的投射物体数（累加所有 pass）、被剔除的数量和跳过的立方体贴图面数
+    static unsigned int shadowCasters;
+    static unsigned int culledCasters;
+    static unsigned int skippedFaces;
+    static void addShadowCulling(unsigned int casters, unsigned int culled)
+    {
+        shadowCasters += casters;
+        culledCasters += culled;
+    }
+    static void addSkippedFace() { ++skippedFaces; }
+
+    // 当前帧重新渲染 / 沿用缓存的阴影图数量
+    static unsigned int shadowMapsRendered;
+    static unsigned int shadowMapsReused;
+    static void addShadowMapUpdate(bool rendered)
+    {
+        if (rendered)
+            ++shadowMapsRendered;
+        else
+            ++shadowMapsReused;
+    }
+
+    // 当前帧提交顺序中着色器程序 / 贴图 / 材质 / mesh 的切换次数（由提交绘制的地方统计）
+    static unsigned int programChanges;
+    static unsigned int textureChanges;
+    static unsigned int materialChanges;
+    static unsigned int meshChanges;
+    static void addStateChanges(unsigned int programs, unsigned int textures, unsigned int materials, unsigned int meshes)
+    {
+        programChanges += programs;
+        textureChanges += textures;
+        materialChanges += materials;
+        meshChanges += meshes;
+    }
+
+    // 当前帧经过 GLState 的绑定调用中实际发出 / 因状态未变而跳过的次数
+    static unsigned int glCallsIssued;
+    static unsigned int glCallsElided;
+    static void addGLCall(bool issued)
+    {
+        if (issued)
+            ++glCallsIssued;
+        else
+            ++glCallsElided;
+    }
+
+    FrameStats();
+
+    // 创建计时查询（需要已有 OpenGL 上下文）
+    void init();
+
+    void beginFrame();
+    void endFrame();
+
+    // 包住主 pass：统计通过深度测试的片段数（即执行光照着色器的片段数），每帧最多一次
+    void beginShadedFragments();
+    void endShadedFragments();
+
+    // 等待所有未完成的查询，输出每帧数据和汇总
+    void finish();
+
+    ~FrameStats();
+
+private:
+    static const int QUERY_RING_SIZE = 3;
+
+    struct FrameRecord
+    {
+        double cpuMs;
+        double gpuMs;
+        unsigned int drawCalls;
+        unsigned long long triangles;
+        unsigned long long vertexBytes;
+        unsigned int visibleObjects;
+        unsigned int culledObjects;
+        unsigned int shadowCasters;
+        unsigned int culledCasters;
+        unsigned int skippedFaces;
+        unsigned int shadowMapsRendered;
+        unsigned int shadowMapsReused;
+        long long shadedFragments; // -1 表示该帧没有统计
+        unsigned int programChanges;
+        unsigned int textureChanges;
+        unsigned int materialChanges;
+        unsigned int meshChanges;
+        unsigned int glCallsIssued;
+        unsigned int glCallsElided;
+    };
+
+    unsigned int queries[QUERY_RING_SIZE];
+    unsigned int fragmentQueries[QUERY_RING_SIZE];
+    bool fragmentQueryUsed[QUERY_RING_SIZE];
+    int queryFrame[QUERY_RING_SIZE]; // 每个查询对应的帧号，-1 表示空闲
+    std::vector<FrameRecord> records;
+    std::chrono::steady_clock::time_point frameStart;
+    int frameIndex;
+    int printedFrames;
+
+    // 读取查询结果；wait 为 false 时结果未就绪就返回 false
+    bool resolveQuery(int slot, bool wait);
+    void printReadyFrames();
+};
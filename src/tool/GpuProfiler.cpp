@@ -0,0 +1,216 @@
+#include "GpuProfiler.h"
+
+#ifdef CG_GPU_PROFILER
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+
+GpuProfiler::GpuProfiler() : enabled(false), periodicPrint(false), frameIndex(0), stalls(0)
+{
+}
+
+GpuProfiler::~GpuProfiler()
+{
+    for (FrameSlot &slot : slots)
+    {
+        if (!slot.queries.empty())
+            glDeleteQueries((GLsizei)slot.queries.size(), slot.queries.data());
+    }
+}
+
+int GpuProfiler::nameIndex(const char *name, int depth)
+{
+    auto it = nameIndices.find(name);
+    if (it != nameIndices.end())
+        return it->second;
+    int index = (int)names.size();
+    names.push_back(name);
+    nameDepths.push_back(depth);
+    nameIndices[name] = index;
+    return index;
+}
+
+unsigned int GpuProfiler::nextQuery(FrameSlot &slot)
+{
+    if (slot.usedQueries == slot.queries.size())
+    {
+        unsigned int query;
+        glGenQueries(1, &query);
+        slot.queries.push_back(query);
+    }
+    return slot.queries[slot.usedQueries++];
+}
+
+void GpuProfiler::beginFrame()
+{
+    if (!enabled)
+        return;
+
+    FrameSlot &slot = slots[frameIndex % RING_SIZE];
+    // 环形缓冲中这一帧的结果还没读出来（GPU 落后了 RING_SIZE 帧），只能等待
+    if (slot.frame >= 0 && !resolve(slot, false))
+    {
+        ++stalls;
+        resolve(slot, true);
+    }
+    // 顺便收取其他已经就绪的帧
+    for (FrameSlot &other : slots)
+    {
+        if (other.frame >= 0)
+            resolve(other, false);
+    }
+
+    slot.frame = frameIndex;
+    slot.sections.clear();
+    slot.usedQueries = 0;
+    stack.clear();
+    begin("frame");
+}
+
+void GpuProfiler::endFrame()
+{
+    if (!enabled)
+        return;
+    end();
+    ++frameIndex;
+    if (periodicPrint && frameIndex % ROLLING_WINDOW == 0)
+        printRolling();
+}
+
+void GpuProfiler::begin(const char *name)
+{
+    if (!enabled)
+        return;
+
+    FrameSlot &slot = slots[frameIndex % RING_SIZE];
+    int depth = (int)stack.size();
+    Section section;
+    section.name = nameIndex(name, depth);
+    section.depth = depth;
+    section.beginQuery = nextQuery(slot);
+    section.endQuery = nextQuery(slot);
+    glQueryCounter(section.beginQuery, GL_TIMESTAMP);
+    stack.push_back((int)slot.sections.size());
+    slot.sections.push_back(section);
+}
+
+void GpuProfiler::end()
+{
+    if (!enabled || stack.empty())
+        return;
+
+    FrameSlot &slot = slots[frameIndex % RING_SIZE];
+    glQueryCounter(slot.sections[stack.back()].endQuery, GL_TIMESTAMP);
+    stack.pop_back();
+}
+
+bool GpuProfiler::resolve(FrameSlot &slot, bool wait)
+{
+    // "frame" 分段的结束时间戳最后发出，它就绪时这一帧的所有查询都已就绪
+    if (!wait)
+    {
+        int available = 0;
+        glGetQueryObjectiv(slot.sections[0].endQuery, GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available)
+            return false;
+    }
+
+    // 同一帧内同名分段的时间相加
+    std::map<int, double> frameTimes;
+    for (const Section &section : slot.sections)
+    {
+        GLuint64 beginNs = 0, endNs = 0;
+        glGetQueryObjectui64v(section.beginQuery, GL_QUERY_RESULT, &beginNs);
+        glGetQueryObjectui64v(section.endQuery, GL_QUERY_RESULT, &endNs);
+        frameTimes[section.name] += (endNs - beginNs) / 1.0e6;
+    }
+    for (const auto &entry : frameTimes)
+        samples.push_back({slot.frame, entry.first, entry.second});
+
+    slot.frame = -1;
+    return true;
+}
+
+int GpuProfiler::statistics(int name, int firstFrame, double &average, double &p95) const
+{
+    // 样本大致按帧号递增，从后往前找到窗口开头即可停止（环形缓冲内的帧可能乱序读出）
+    std::vector<double> values;
+    for (auto it = samples.rbegin(); it != samples.rend() && it->frame >= firstFrame - RING_SIZE; ++it)
+    {
+        if (it->name == name && it->frame >= firstFrame)
+            values.push_back(it->ms);
+    }
+    if (values.empty())
+        return 0;
+
+    double sum = 0.0;
+    for (double value : values)
+        sum += value;
+    average = sum / values.size();
+    std::sort(values.begin(), values.end());
+    size_t rank = (size_t)std::ceil(0.95 * values.size());
+    p95 = values[std::max(rank, (size_t)1) - 1];
+    return (int)values.size();
+}
+
+void GpuProfiler::printTable(const char *title, int firstFrame) const
+{
+    std::printf("%s\n", title);
+    for (size_t i = 0; i < names.size(); ++i)
+    {
+        double average = 0.0, p95 = 0.0;
+        int count = statistics((int)i, firstFrame, average, p95);
+        if (count == 0)
+            continue;
+        std::printf("  %*s%-*s %8.3f ms avg  %8.3f ms p95  (%d frames)\n", nameDepths[i] * 2, "",
+                    28 - nameDepths[i] * 2, names[i].c_str(), average, p95, count);
+    }
+}
+
+void GpuProfiler::printRolling() const
+{
+    if (!enabled || samples.empty())
+        return;
+    int lastFrame = 0;
+    for (const Sample &sample : samples)
+        lastFrame = std::max(lastFrame, sample.frame);
+    printTable("gpu passes (rolling):", lastFrame + 1 - ROLLING_WINDOW);
+}
+
+void GpuProfiler::finish(const std::string &csvPath)
+{
+    if (!enabled)
+        return;
+
+    for (FrameSlot &slot : slots)
+    {
+        if (slot.frame >= 0)
+            resolve(slot, true);
+    }
+    std::stable_sort(samples.begin(), samples.end(), [](const Sample &a, const Sample &b)
+                     { return a.frame < b.frame; });
+
+    // 第一帧包含驱动的延迟初始化，不计入汇总
+    char title[128];
+    std::snprintf(title, sizeof(title), "gpu passes (%d frames, first excluded, %d stalls):", frameIndex, stalls);
+    printTable(title, frameIndex > 1 ? 1 : 0);
+    std::snprintf(title, sizeof(title), "gpu passes (last %d frames):", std::min(frameIndex, (int)ROLLING_WINDOW));
+    printTable(title, frameIndex - ROLLING_WINDOW);
+
+    if (csvPath.empty())
+        return;
+    FILE *file = std::fopen(csvPath.c_str(), "w");
+    if (!file)
+    {
+        std::cout << "Failed to write GPU profile: " << csvPath << std::endl;
+        return;
+    }
+    std::fprintf(file, "frame,section,depth,ms\n");
+    for (const Sample &sample : samples)
+        std::fprintf(file, "%d,%s,%d,%.6f\n", sample.frame, names[sample.name].c_str(), nameDepths[sample.name], sample.ms);
+    std::fclose(file);
+}
+
+#endif
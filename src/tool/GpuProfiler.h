@@ -0,0 +1,119 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <map>
+#include <string>
+#include <vector>
+
+// GPU 分段计时：每个分段（pass、立方体贴图的一个面……）前后各记录一个 GL_TIMESTAMP 查询，
+// 时间戳可以嵌套，每帧开头自动开始一个 "frame" 分段包住整帧
+// 查询按帧放在环形缓冲中，几帧之后再读取结果，不会让 CPU 等待 GPU；
+// 环形缓冲用完时才会等待最旧的一帧（记为一次停顿）
+// 汇总输出每个分段的平均值、最近 ROLLING_WINDOW 帧的滚动平均和 p95，可以把每帧的数据写成 CSV
+// 构建时关闭 CG_GPU_PROFILER 后换成同名的空实现，调用点全部被编译器消除
+#ifdef CG_GPU_PROFILER
+class GpuProfiler
+{
+public:
+    static const int RING_SIZE = 4;       // 查询环形缓冲的帧数（结果在 RING_SIZE - 1 帧之后读取）
+    static const int ROLLING_WINDOW = 60; // 滚动平均和 p95 使用的帧数
+
+    // 在作用域内计时一个分段
+    class Scope
+    {
+    public:
+        Scope(GpuProfiler &profiler, const char *name) : profiler(profiler) { profiler.begin(name); }
+        ~Scope() { profiler.end(); }
+
+    private:
+        GpuProfiler &profiler;
+    };
+
+    GpuProfiler();
+    ~GpuProfiler();
+
+    // 运行时开关（默认关闭，关闭时每个调用只有一次判断）
+    void setEnabled(bool enabled) { this->enabled = enabled; }
+    bool isEnabled() const { return enabled; }
+    // 每 ROLLING_WINDOW 帧输出一次滚动统计（窗口模式使用）
+    void setPeriodicPrint(bool enabled) { periodicPrint = enabled; }
+
+    void beginFrame();
+    void endFrame();
+
+    // 分段名使用字符串常量；同一帧内同名的分段时间相加（例如静态层和动态层的点光源阴影）
+    void begin(const char *name);
+    void end();
+
+    // 输出最近 ROLLING_WINDOW 帧的滚动统计
+    void printRolling() const;
+
+    // 等待所有未完成的查询，输出汇总；csvPath 非空时写出每帧每个分段的时间
+    void finish(const std::string &csvPath);
+
+private:
+    struct Section
+    {
+        int name;  // names 中的下标
+        int depth; // 嵌套深度（frame 为 0）
+        unsigned int beginQuery;
+        unsigned int endQuery;
+    };
+
+    struct FrameSlot
+    {
+        int frame = -1; // 占用这个位置的帧号，-1 表示空闲
+        std::vector<Section> sections;
+        std::vector<unsigned int> queries; // 查询对象池，按需增长
+        size_t usedQueries = 0;
+    };
+
+    // 一帧内一个分段的时间
+    struct Sample
+    {
+        int frame;
+        int name;
+        double ms;
+    };
+
+    bool enabled;
+    bool periodicPrint;
+    int frameIndex;
+    int stalls;
+    FrameSlot slots[RING_SIZE];
+    std::vector<int> stack; // 当前帧未结束的分段（sections 中的下标）
+
+    std::vector<std::string> names;
+    std::vector<int> nameDepths;
+    std::map<std::string, int> nameIndices;
+    std::vector<Sample> samples;
+
+    int nameIndex(const char *name, int depth);
+    unsigned int nextQuery(FrameSlot &slot);
+    // 读取一帧的查询结果；wait 为 false 时结果未就绪就返回 false
+    bool resolve(FrameSlot &slot, bool wait);
+    // 统计 name 在 [firstFrame, frameCount) 帧内的平均值和 p95，返回参与统计的帧数
+    int statistics(int name, int firstFrame, double &average, double &p95) const;
+    void printTable(const char *title, int firstFrame) const;
+};
+#else
+class GpuProfiler
+{
+public:
+    class Scope
+    {
+    public:
+        Scope(GpuProfiler &, const char *) {}
+    };
+
+    void setEnabled(bool) {}
+    bool isEnabled() const { return false; }
+    void setPeriodicPrint(bool) {}
+    void beginFrame() {}
+    void endFrame() {}
+    void begin(const char *) {}
+    void end() {}
+    void printRolling() const {}
+    void finish(const std::string &) {}
+};
+#endif
@@ -0,0 +1,87 @@
+#include "HeadlessContext.h"
+
+#ifdef CG_HAS_EGL
+
+#include <EGL/eglext.h>
+#include <iostream>
+
+bool HeadlessContext::create(int majorVersion, int minorVersion)
+{
+    // 优先使用 Mesa 的 surfaceless 平台（不需要 X11 / Wayland / DRM 设备）
+    PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay =
+        (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+    if (getPlatformDisplay)
+        display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, NULL);
+    if (display == EGL_NO_DISPLAY)
+        display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+
+    EGLint eglMajor, eglMinor;
+    if (display == EGL_NO_DISPLAY || !eglInitialize(display, &eglMajor, &eglMinor))
+    {
+        std::cout << "Failed to initialize EGL display" << std::endl;
+        return false;
+    }
+
+    if (!eglBindAPI(EGL_OPENGL_API))
+    {
+        std::cout << "EGL: desktop OpenGL API is not supported" << std::endl;
+        return false;
+    }
+
+    // 选一个支持桌面 OpenGL 的 config；surfaceless 平台可能没有 config，此时使用 configless 上下文
+    const EGLint configAttribs[] = {
+        EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+        EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+        EGL_NONE};
+    EGLConfig config = (EGLConfig)0;
+    EGLint numConfigs = 0;
+    eglChooseConfig(display, configAttribs, &config, 1, &numConfigs);
+
+    const EGLint contextAttribs[] = {
+        EGL_CONTEXT_MAJOR_VERSION, majorVersion,
+        EGL_CONTEXT_MINOR_VERSION, minorVersion,
+        EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+        EGL_NONE};
+    context = eglCreateContext(display, numConfigs > 0 ? config : (EGLConfig)0, EGL_NO_CONTEXT, contextAttribs);
+    if (context == EGL_NO_CONTEXT)
+    {
+        std::cout << "Failed to create EGL OpenGL " << majorVersion << "." << minorVersion
+                  << " core context (error 0x" << std::hex << eglGetError() << std::dec << ")" << std::endl;
+        return false;
+    }
+
+    // 所有渲染都进 FBO，这里只需要一个 1x1 的 pbuffer（或者干脆没有 surface）
+    if (numConfigs > 0)
+    {
+        const EGLint pbufferAttribs[] = {EGL_WIDTH, 1, EGL_HEIGHT, 1, EGL_NONE};
+        surface = eglCreatePbufferSurface(display, config, pbufferAttribs);
+    }
+
+    if (!eglMakeCurrent(display, surface, surface, context))
+    {
+        std::cout << "Failed to make EGL context current" << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+void *HeadlessContext::getProcAddress(const char *name)
+{
+    return (void *)eglGetProcAddress(name);
+}
+
+HeadlessContext::~HeadlessContext()
+{
+    if (display == EGL_NO_DISPLAY)
+        return;
+
+    eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    if (surface != EGL_NO_SURFACE)
+        eglDestroySurface(display, surface);
+    if (context != EGL_NO_CONTEXT)
+        eglDestroyContext(display, context);
+    eglTerminate(display);
+}
+
+#endif
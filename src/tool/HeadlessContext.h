@@ -0,0 +1,29 @@
+#pragma once
+
+// 离屏 OpenGL 上下文（EGL，无窗口、无显示器）
+// 在没有 GPU 的 Linux 机器上由 Mesa llvmpipe 提供软件实现
+// 只在定义了 CG_HAS_EGL 的平台上可用，其他平台的离屏模式使用隐藏的 glfw 窗口
+#ifdef CG_HAS_EGL
+
+#include <EGL/egl.h>
+
+class HeadlessContext
+{
+public:
+    HeadlessContext() {}
+
+    // 创建 core profile 上下文并设为当前上下文
+    bool create(int majorVersion, int minorVersion);
+
+    // 供 glad 加载函数指针
+    static void *getProcAddress(const char *name);
+
+    ~HeadlessContext();
+
+private:
+    EGLDisplay display = EGL_NO_DISPLAY;
+    EGLContext context = EGL_NO_CONTEXT;
+    EGLSurface surface = EGL_NO_SURFACE;
+};
+
+#endif
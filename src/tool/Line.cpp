@@ -1,15 +1,18 @@
 #include "Line.h"
+#include "FrameStats.h"
+#include "../render/GLState.h"
+#include "../ShaderLibrary.h"
 
 Line::Line(const char *vertexPath, const char *fragmentPath, glm::vec3 start, glm::vec3 end, Material *material)
 {
-    shader = new Shader(vertexPath, fragmentPath);
+    shader = ShaderLibrary::get(vertexPath, fragmentPath);
     material = material;
 
     // 创建 VAO 和 VBO
     glGenVertexArrays(1, &VAO);
     glGenBuffers(1, &VBO);
 
-    glBindVertexArray(VAO);
+    GLState::bindVertexArray(VAO);
 
     // 设置线段的两个端点
     vertices[0] = start.x;
@@ -27,28 +30,25 @@ Line::Line(const char *vertexPath, const char *fragmentPath, glm::vec3 start, gl
     glEnableVertexAttribArray(0);
 
     glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
 }
 
-void Line::render(glm::mat4 uModel, glm::mat4 uView, glm::mat4 uProjection)
+void Line::render(glm::mat4 uModel)
 {
     shader->use();
 
-    // 传递MVP矩阵到着色器
+    // 传递模型矩阵到着色器（视图和投影矩阵来自 CameraBlock）
     shader->setMat4("uModel", uModel);
-    shader->setMat4("uView", uView);
-    shader->setMat4("uProjection", uProjection);
 
     glLineWidth(lineWidth);
 
-    glBindVertexArray(VAO);
+    GLState::bindVertexArray(VAO);
     glDrawArrays(GL_LINES, 0, 2); // 绘制线段
-    glBindVertexArray(0);
+    FrameStats::addDrawCall();
 }
 
 Line::~Line()
 {
+    GLState::forgetVertexArray(VAO);
     glDeleteVertexArrays(1, &VAO);
     glDeleteBuffers(1, &VBO);
-    delete shader;
 }
@@ -2,6 +2,7 @@
 
 #include <glad/glad.h>
 #include <glm/glm.hpp>
+#include <memory>
 
 #include "../Shader.h"
 #include "../material/Material.h"
@@ -11,13 +12,13 @@ class Line
 public:
     Line(const char* vertexPath, const char* fragmentPath, glm::vec3 start, glm::vec3 end, Material *material);
 
-    void render(glm::mat4 uModel, glm::mat4 uView, glm::mat4 uProjection);
+    void render(glm::mat4 uModel);
 
     ~Line();
 
 private:
     unsigned int VBO, VAO;
-    Shader* shader;
+    std::shared_ptr<Shader> shader; // 由 ShaderLibrary 共享
     Material *material; // 材质对象，用于渲染时应用
 
     glm::vec3 start, end;
@@ -1,15 +1,18 @@
 #include "Point.h"
+#include "FrameStats.h"
+#include "../render/GLState.h"
+#include "../ShaderLibrary.h"
 
 Point::Point(const char *vertexPath, const char *fragmentPath,Material *material)
 {
-    shader = new Shader(vertexPath, fragmentPath);
+    shader = ShaderLibrary::get(vertexPath, fragmentPath);
     material = material;
 
     // 创建 VAO 和 VBO
     glGenVertexArrays(1, &VAO);
     glGenBuffers(1, &VBO);
 
-    glBindVertexArray(VAO);
+    GLState::bindVertexArray(VAO);
 
     // 设置顶点数据
     vertices[0] = position.x;
@@ -24,28 +27,25 @@ Point::Point(const char *vertexPath, const char *fragmentPath,Material *material
     glEnableVertexAttribArray(0);
 
     glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
 }
 
-void Point::render(glm::mat4 uModel, glm::mat4 uView, glm::mat4 uProjection)
+void Point::render(glm::mat4 uModel)
 {
     shader->use();
 
-    // 传递MVP矩阵到着色器
+    // 传递模型矩阵到着色器（视图和投影矩阵来自 CameraBlock）
     shader->setMat4("uModel", uModel);
-    shader->setMat4("uView", uView);
-    shader->setMat4("uProjection", uProjection);
 
     glPointSize(pointSize);
 
-    glBindVertexArray(VAO);
+    GLState::bindVertexArray(VAO);
     glDrawArrays(GL_POINTS, 0, 1); // 绘制单个点
-    glBindVertexArray(0);
+    FrameStats::addDrawCall();
 }
 
 Point::~Point()
 {
+    GLState::forgetVertexArray(VAO);
     glDeleteVertexArrays(1, &VAO);
     glDeleteBuffers(1, &VBO);
-    delete shader;
 }
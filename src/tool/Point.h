@@ -2,6 +2,7 @@
 
 #include <glad/glad.h>
 #include <glm/glm.hpp>
+#include <memory>
 
 #include "../Shader.h"
 #include "../material/Material.h"
@@ -11,7 +12,7 @@ class Point
 public:
     Point(const char *vertexPath, const char *fragmentPath, Material *material);
 
-    void render(glm::mat4 uModel, glm::mat4 uView, glm::mat4 uProjection);
+    void render(glm::mat4 uModel);
 
     void setPosition(glm::vec3 position) { this->position = position; }
 
@@ -19,7 +20,7 @@ public:
 
 private:
     unsigned int VBO, VAO;
-    Shader *shader;
+    std::shared_ptr<Shader> shader; // 由 ShaderLibrary 共享
     Material *material; // 材质对象，用于渲染时应用
 
     glm::vec3 position;
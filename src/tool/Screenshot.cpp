@@ -0,0 +1,117 @@
+#include "Screenshot.h"
+#include "../render/GLState.h"
+
+#include <glad/glad.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+
+std::vector<unsigned char> Screenshot::readPixels(unsigned int fbo, int width, int height)
+{
+    size_t rowBytes = (size_t)width * 3;
+    std::vector<unsigned char> pixels(rowBytes * height);
+    GLState::bindFramebuffer(GL_READ_FRAMEBUFFER, fbo);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, width, height, GL_RGB, GL_UNSIGNED_BYTE, pixels.data());
+
+    // OpenGL 的原点在左下角，PPM 从上到下存储
+    for (int y = 0; y < height / 2; ++y)
+        std::swap_ranges(pixels.begin() + y * rowBytes, pixels.begin() + (y + 1) * rowBytes,
+                         pixels.begin() + (height - 1 - y) * rowBytes);
+    return pixels;
+}
+
+bool Screenshot::save(unsigned int fbo, int width, int height, const std::string &path)
+{
+    std::vector<unsigned char> pixels = readPixels(fbo, width, height);
+
+    FILE *file = std::fopen(path.c_str(), "wb");
+    if (!file)
+    {
+        std::cout << "Failed to write screenshot: " << path << std::endl;
+        return false;
+    }
+    std::fprintf(file, "P6\n%d %d\n255\n", width, height);
+    std::fwrite(pixels.data(), 1, pixels.size(), file);
+    std::fclose(file);
+    return true;
+}
+
+bool Screenshot::load(const std::string &path, int &width, int &height, std::vector<unsigned char> &pixels)
+{
+    FILE *file = std::fopen(path.c_str(), "rb");
+    if (!file)
+        return false;
+
+    // 只支持 save() 写出的格式：P6、8 位、头部没有注释
+    int maxValue = 0;
+    bool ok = std::fscanf(file, "P6 %d %d %d", &width, &height, &maxValue) == 3 && maxValue == 255 &&
+              width > 0 && height > 0 && std::fgetc(file) != EOF;
+    if (ok)
+    {
+        pixels.resize((size_t)width * height * 3);
+        ok = std::fread(pixels.data(), 1, pixels.size(), file) == pixels.size();
+    }
+    std::fclose(file);
+    return ok;
+}
+
+bool Screenshot::compare(unsigned int fbo, int width, int height, const std::string &referencePath,
+                         double minPsnr, long long maxDifferentPixels)
+{
+    int referenceWidth = 0, referenceHeight = 0;
+    std::vector<unsigned char> reference;
+    if (!load(referencePath, referenceWidth, referenceHeight, reference))
+    {
+        std::cout << "Failed to read reference image (binary PPM expected): " << referencePath << std::endl;
+        return false;
+    }
+    if (referenceWidth != width || referenceHeight != height)
+    {
+        std::cout << "Reference image is " << referenceWidth << "x" << referenceHeight << ", rendered " << width << "x"
+                  << height << std::endl;
+        return false;
+    }
+
+    std::vector<unsigned char> pixels = readPixels(fbo, width, height);
+    int maxDiff = 0;
+    double sum = 0.0, squaredSum = 0.0;
+    size_t differentPixels = 0;
+    for (size_t i = 0; i < pixels.size(); i += 3)
+    {
+        int pixelMax = 0;
+        for (size_t c = i; c < i + 3; ++c)
+        {
+            int diff = std::abs((int)pixels[c] - (int)reference[c]);
+            pixelMax = std::max(pixelMax, diff);
+            sum += diff;
+            squaredSum += (double)diff * diff;
+        }
+        maxDiff = std::max(maxDiff, pixelMax);
+        if (pixelMax > DIFF_THRESHOLD)
+            ++differentPixels;
+    }
+
+    double mse = squaredSum / pixels.size();
+    double psnr = mse > 0.0 ? 10.0 * std::log10(255.0 * 255.0 / mse) : INFINITY;
+    size_t pixelCount = (size_t)width * height;
+    std::printf("image diff vs %s: max %d  mean %.4f  PSNR %.2f dB  %zu pixels (%.3f%%) differ by more than %d\n",
+                referencePath.c_str(), maxDiff, sum / pixels.size(), psnr,
+                differentPixels, 100.0 * differentPixels / pixelCount, DIFF_THRESHOLD);
+
+    bool passed = true;
+    if (psnr < minPsnr)
+    {
+        std::printf("image diff FAILED: PSNR %.2f dB is below the minimum %.2f dB\n", psnr, minPsnr);
+        passed = false;
+    }
+    if (maxDifferentPixels >= 0 && (long long)differentPixels > maxDifferentPixels)
+    {
+        std::printf("image diff FAILED: %zu pixels differ by more than %d, at most %lld allowed\n",
+                    differentPixels, DIFF_THRESHOLD, maxDifferentPixels);
+        passed = false;
+    }
+    return passed;
+}
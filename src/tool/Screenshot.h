@@ -0,0 +1,25 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+// 离屏模式下保存帧缓冲内容，便于比较不同渲染路径的输出
+class Screenshot
+{
+public:
+    // 读取 fbo 的颜色附件并保存为二进制 PPM（P6）
+    static bool save(unsigned int fbo, int width, int height, const std::string &path);
+
+    // 把 fbo 的颜色附件和参考 PPM 逐像素比较，输出最大 / 平均差、PSNR 和差值超过 DIFF_THRESHOLD 的像素数
+    // （用于确认优化前后画面等价：先用 --screenshot 保存参考图，再用 --diff-against 比较）
+    // 参考图读取失败、尺寸不同、PSNR 低于 minPsnr 或明显不同的像素超过 maxDifferentPixels（负数不限制）时返回 false
+    static bool compare(unsigned int fbo, int width, int height, const std::string &referencePath,
+                        double minPsnr, long long maxDifferentPixels);
+
+    static const int DIFF_THRESHOLD = 8; // 单个通道差值超过它的像素算作明显不同（0-255）
+
+private:
+    // 读出 RGB 像素，按 PPM 的顺序从上到下排列
+    static std::vector<unsigned char> readPixels(unsigned int fbo, int width, int height);
+    static bool load(const std::string &path, int &width, int &height, std::vector<unsigned char> &pixels);
+};